@@ -28,6 +28,18 @@ namespace boost { namespace locale { namespace conv { namespace detail {
         {
             return convert(text.data(), text.data() + text.length());
         }
+        /// Append the converted text to \a out and return the number of appended characters.
+        /// \a out is unchanged when the conversion fails.
+        size_t convert(const CharIn* begin, const CharIn* end, string_type& out) { return do_append(begin, end, out); }
+
+    protected:
+        /// Implementation of appending \a convert which must leave \a out unchanged when the conversion fails
+        virtual size_t do_append(const CharIn* begin, const CharIn* end, string_type& out)
+        {
+            const string_type result = convert(begin, end);
+            out.append(result);
+            return result.size();
+        }
     };
 
     using narrow_converter = charset_converter<char, char>;
@@ -38,6 +50,24 @@ namespace boost { namespace locale { namespace conv { namespace detail {
     template<typename CharType>
     using utf_decoder = charset_converter<CharType, char>;
 
+    /// Converter for a text given in consecutive chunks keeping incomplete sequences and shift states between them
+    template<typename CharIn, typename CharOut>
+    class BOOST_SYMBOL_VISIBLE stream_converter {
+    public:
+        using char_out_type = CharOut;
+        using char_in_type = CharIn;
+        using string_type = std::basic_string<CharOut>;
+
+        virtual ~stream_converter() = default;
+        /// Append the conversion of [begin, end) to \a out and return the number of appended characters.
+        /// An incomplete sequence at the end is kept for the next call unless \a last is true,
+        /// in which case the converter returns to its initial state afterwards.
+        /// On failure \a out is unchanged and the converter is reset.
+        virtual size_t convert(const CharIn* begin, const CharIn* end, string_type& out, bool last) = 0;
+        /// Discard kept input and return to the initial state
+        virtual void reset() = 0;
+    };
+
     enum class conv_backend { Default, IConv, ICU, WinAPI };
 
     template<typename Char>
@@ -51,6 +81,13 @@ namespace boost { namespace locale { namespace conv { namespace detail {
                           const std::string& target_encoding,
                           method_type how,
                           conv_backend impl = conv_backend::Default);
+    /// The encoding of a side with a character type other than \c char is ignored and UTF is used
+    template<typename CharIn, typename CharOut>
+    BOOST_LOCALE_DECL std::unique_ptr<stream_converter<CharIn, CharOut>>
+    make_stream_converter(const std::string& src_encoding,
+                          const std::string& target_encoding,
+                          method_type how,
+                          conv_backend impl = conv_backend::Default);
 }}}} // namespace boost::locale::conv::detail
 
 /// \endcond
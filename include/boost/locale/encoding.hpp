@@ -246,6 +246,24 @@ namespace boost { namespace locale {
             ///
             /// \throws conversion_error: Conversion failed
             string_type operator()(const core::string_view text) const { return convert(text); }
+
+            /// Convert text in range [begin,end) to UTF and append it to \a out
+            ///
+            /// Reusing \a out for multiple conversions avoids allocating a new string for each of them.
+            /// \return Number of characters appended to \a out, the input is always consumed completely
+            /// \throws conversion_error: Conversion failed, \a out is not modified
+            size_t convert(const char* begin, const char* end, string_type& out) const
+            {
+                return impl_->convert(begin, end, out);
+            }
+            /// Convert \a text to UTF and append it to \a out
+            ///
+            /// \return Number of characters appended to \a out
+            /// \throws conversion_error: Conversion failed, \a out is not modified
+            size_t convert(const core::string_view text, string_type& out) const
+            {
+                return convert(text.data(), text.data() + text.size(), out);
+            }
         };
 
         /// Converter class to decode an UTF string and encode it using a local encoding
@@ -277,6 +295,24 @@ namespace boost { namespace locale {
             ///
             /// \throws conversion_error: Conversion failed
             std::string operator()(const stringview_type& text) const { return convert(text); }
+
+            /// Convert UTF text in range [begin,end) to local encoding and append it to \a out
+            ///
+            /// Reusing \a out for multiple conversions avoids allocating a new string for each of them.
+            /// \return Number of characters appended to \a out, the input is always consumed completely
+            /// \throws conversion_error: Conversion failed, \a out is not modified
+            size_t convert(const CharType* begin, const CharType* end, std::string& out) const
+            {
+                return impl_->convert(begin, end, out);
+            }
+            /// Convert \a text from UTF to local encoding and append it to \a out
+            ///
+            /// \return Number of characters appended to \a out
+            /// \throws conversion_error: Conversion failed, \a out is not modified
+            size_t convert(const stringview_type& text, std::string& out) const
+            {
+                return convert(text.data(), text.data() + text.size(), out);
+            }
         };
 
         class narrow_converter {
@@ -304,6 +340,100 @@ namespace boost { namespace locale {
             ///
             /// \throws conversion_error: Conversion failed
             std::string operator()(const core::string_view text) const { return convert(text); }
+
+            /// Convert text in range [begin,end) and append it to \a out
+            ///
+            /// Reusing \a out for multiple conversions avoids allocating a new string for each of them.
+            /// \return Number of characters appended to \a out, the input is always consumed completely
+            /// \throws conversion_error: Conversion failed, \a out is not modified
+            size_t convert(const char* begin, const char* end, std::string& out) const
+            {
+                return impl_->convert(begin, end, out);
+            }
+            /// Convert \a text and append it to \a out
+            ///
+            /// \return Number of characters appended to \a out
+            /// \throws conversion_error: Conversion failed, \a out is not modified
+            size_t convert(const core::string_view text, std::string& out) const
+            {
+                return convert(text.data(), text.data() + text.size(), out);
+            }
+        };
+
+        /// Converter class to convert a text given in consecutive chunks, e.g. read from a network stream
+        ///
+        /// In contrast to \ref utf_encoder, \ref utf_decoder and \ref narrow_converter an incomplete multi-byte
+        /// sequence at the end of a chunk is kept and completed by the next chunk and the shift state of stateful
+        /// encodings (e.g. ISO-2022-JP or UTF-7) is carried over, so the result does not depend on how the text
+        /// is split. Only the input of a single incomplete character is kept between chunks.
+        ///
+        /// For character types other than \c char the encoding is always UTF.
+        template<typename CharIn, typename CharOut>
+        class stream_converter {
+            std::unique_ptr<detail::stream_converter<CharIn, CharOut>> impl_;
+
+        public:
+            using char_in_type = CharIn;
+            using char_out_type = CharOut;
+            using string_type = std::basic_string<CharOut>;
+            using stringview_type = core::basic_string_view<CharIn>;
+
+            /// Create converter to convert text from \a src_encoding to \a target_encoding according to policy \a how
+            ///
+            /// The encoding of a character type other than \c char is ignored.
+            /// \throws invalid_charset_error: Either character set is not supported
+            stream_converter(const std::string& src_encoding,
+                             const std::string& target_encoding = "UTF-8",
+                             method_type how = default_method) :
+                impl_(detail::make_stream_converter<CharIn, CharOut>(src_encoding, target_encoding, how))
+            {}
+
+            /// Convert the next chunk of text in range [begin,end) and append the result to \a out
+            ///
+            /// \return Number of characters appended to \a out
+            /// \throws conversion_error: Conversion failed, \a out is not modified and the converter is \ref reset
+            size_t convert(const CharIn* begin, const CharIn* end, string_type& out)
+            {
+                return impl_->convert(begin, end, out, false);
+            }
+            /// Convert the next chunk \a text and append the result to \a out
+            ///
+            /// \return Number of characters appended to \a out
+            /// \throws conversion_error: Conversion failed, \a out is not modified and the converter is \ref reset
+            size_t convert(const stringview_type& text, string_type& out)
+            {
+                return convert(text.data(), text.data() + text.size(), out);
+            }
+            /// Convert the next chunk \a text
+            ///
+            /// \throws conversion_error: Conversion failed, the converter is \ref reset
+            string_type convert(const stringview_type& text)
+            {
+                string_type result;
+                convert(text, result);
+                return result;
+            }
+
+            /// End the text: Convert the kept input and return to the initial shift state appending to \a out
+            ///
+            /// Afterwards the converter can be used for a new text.
+            /// \return Number of characters appended to \a out
+            /// \throws conversion_error: Conversion failed (e.g. the text ended with an incomplete sequence and
+            /// the policy is \c stop), \a out is not modified and the converter is \ref reset
+            size_t finish(string_type& out) { return impl_->convert(nullptr, nullptr, out, true); }
+            /// End the text: Convert the kept input and return to the initial shift state
+            ///
+            /// Afterwards the converter can be used for a new text.
+            /// \throws conversion_error: Conversion failed, the converter is \ref reset
+            string_type finish()
+            {
+                string_type result;
+                finish(result);
+                return result;
+            }
+
+            /// Discard the kept input and return to the initial state to start a new text
+            void reset() { impl_->reset(); }
         };
     } // namespace conv
 }}    // namespace boost::locale
@@ -12,6 +12,8 @@
 #include <boost/locale/encoding_errors.hpp>
 #include <boost/locale/utf.hpp>
 #include <boost/locale/util/string.hpp>
+#include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <memory>
 #include <type_traits>
@@ -22,10 +24,117 @@
 #endif
 
 namespace boost { namespace locale { namespace conv {
+    /// \cond INTERNAL
+    namespace detail {
+        constexpr std::ptrdiff_t ascii_block_size = 16;
+        constexpr std::ptrdiff_t max_ascii_chunk_size = 64 * ascii_block_size;
+
+        template<typename Char>
+        bool is_ascii(const Char c)
+        {
+            return static_cast<typename std::make_unsigned<Char>::type>(c) < 0x80;
+        }
+
+        /// Return the end of the blocks of ASCII characters starting at \a begin
+        ///
+        /// ASCII characters are encoded the same in all UTF encodings and common in most texts.
+        /// Checking blocks of characters at once allows compilers to vectorize this.
+        template<typename Char>
+        const Char* skip_ascii_blocks(const Char* begin, const Char* end)
+        {
+            using unsigned_char = typename std::make_unsigned<Char>::type;
+            while(end - begin >= ascii_block_size) {
+                unsigned_char bits = 0;
+                for(std::ptrdiff_t i = 0; i < ascii_block_size; i++)
+                    bits |= static_cast<unsigned_char>(begin[i]);
+                if(bits >= 0x80)
+                    break;
+                begin += ascii_block_size;
+            }
+            return begin;
+        }
+
+        /// Append the blocks of ASCII characters starting at \a begin to \a out and return their end
+        template<typename CharIn, typename CharOut, class Traits, class Alloc>
+        BOOST_NOINLINE const CharIn*
+        append_ascii_blocks(const CharIn* begin, const CharIn* end, std::basic_string<CharOut, Traits, Alloc>& out)
+        {
+            const CharIn* const ascii_end = skip_ascii_blocks(begin, end);
+            if(ascii_end != begin) {
+                const size_t pos = out.size();
+                out.resize(pos + (ascii_end - begin));
+                std::copy(begin, ascii_end, &out[pos]);
+            }
+            return ascii_end;
+        }
+
+        /// Append the conversion of [begin, end) to \a out, return false if \a how is \c stop and that fails
+        template<typename CharIn, typename CharOut, class Traits, class Alloc>
+        BOOST_NOINLINE bool append_utf(const CharIn* begin,
+                                       const CharIn* end,
+                                       std::basic_string<CharOut, Traits, Alloc>& out,
+                                       method_type how)
+        {
+            auto inserter = std::back_inserter(out);
+            while(begin != end) {
+                const utf::code_point c = utf::utf_traits<CharIn>::decode(begin, end);
+                if(c == utf::illegal || c == utf::incomplete) {
+                    if(how == stop)
+                        return false;
+                } else
+                    utf::utf_traits<CharOut>::encode(c, inserter);
+            }
+            return true;
+        }
+    } // namespace detail
+    /// \endcond
+
     /// \addtogroup codepage
     ///
     /// @{
 
+    /// Convert a Unicode text in range [begin,end) to other Unicode encoding and append it to \a out
+    ///
+    /// Reusing \a out for multiple conversions avoids allocating a new string for each of them.
+    /// \return Number of characters appended to \a out, the input is always consumed completely
+    /// \throws conversion_error: Conversion failed (e.g. \a how is \c stop and any character cannot be decoded),
+    /// \a out is not modified
+    template<typename CharOut, typename CharIn, class Traits, class Alloc>
+    size_t utf_to_utf(const CharIn* begin,
+                      const CharIn* end,
+                      std::basic_string<CharOut, Traits, Alloc>& out,
+                      method_type how = default_method)
+    {
+        const size_t old_size = out.size();
+        // Reserving exactly the required size for each call would make repeated appends quadratic
+        const size_t required_size = old_size + static_cast<size_t>(end - begin);
+        if(out.capacity() < required_size)
+            out.reserve(std::max(required_size, 2 * out.capacity()));
+        // Copy blocks of ASCII characters in bulk at the start of chunks, which get longer while there are none.
+        // A chunk ends after an ASCII character, so no sequence is split and it can be decoded on its own.
+        std::ptrdiff_t chunk_size = detail::ascii_block_size;
+        while(begin != end) {
+            const CharIn* const ascii_end = detail::append_ascii_blocks(begin, end, out);
+            if(ascii_end != begin) {
+                begin = ascii_end;
+                chunk_size = detail::ascii_block_size;
+            } else if(chunk_size < detail::max_ascii_chunk_size)
+                chunk_size *= 2;
+            const CharIn* chunk_end = end;
+            if(end - begin > chunk_size) {
+                chunk_end = std::find_if(begin + chunk_size - 1, end, detail::is_ascii<CharIn>);
+                if(chunk_end != end)
+                    ++chunk_end;
+            }
+            if(!detail::append_utf(begin, chunk_end, out, how)) {
+                out.resize(old_size);
+                throw conversion_error();
+            }
+            begin = chunk_end;
+        }
+        return out.size() - old_size;
+    }
+
     /// Convert a Unicode text in range [begin,end) to other Unicode encoding
     ///
     /// \throws conversion_error: Conversion failed (e.g. \a how is \c stop and any character cannot be decoded)
@@ -35,15 +144,7 @@ namespace boost { namespace locale { namespace conv {
     {
         std::basic_string<CharOut, std::char_traits<CharOut>, Alloc> result(alloc);
         result.reserve(end - begin);
-        auto inserter = std::back_inserter(result);
-        while(begin != end) {
-            const utf::code_point c = utf::utf_traits<CharIn>::decode(begin, end);
-            if(c == utf::illegal || c == utf::incomplete) {
-                if(how == stop)
-                    throw conversion_error();
-            } else
-                utf::utf_traits<CharOut>::encode(c, inserter);
-        }
+        utf_to_utf(begin, end, result, how);
         return result;
     }
 
@@ -8,10 +8,14 @@
 #define BOOST_LOCALE_GENERATOR_HPP
 
 #include <boost/locale/hold_ptr.hpp>
+#include <chrono>
 #include <cstdint>
+#include <exception>
+#include <functional>
 #include <locale>
 #include <memory>
 #include <string>
+#include <vector>
 
 #ifdef BOOST_MSVC
 #    pragma warning(push)
@@ -94,6 +98,38 @@ namespace locale {
     /// Generate all of them
     constexpr category_t all_categories = category_t(0xFFFFFFFFu);
 
+    /// Statistics of the locale cache of a \ref generator
+    struct locale_cache_statistics {
+        uint64_t hits = 0;   ///< Number of locales returned from the cache or generated concurrently by another call
+        uint64_t misses = 0; ///< Number of locales generated for the cache
+        uint64_t evictions = 0; ///< Number of locales removed from the cache to stay within its limit
+        std::chrono::nanoseconds generation_time{0}; ///< Total time spent generating locales for the cache
+    };
+
+    /// \brief Observer of the events of locale generation, e.g. to find out which locales and categories are costly
+    ///
+    /// Events are only reported if the library was built with instrumentation enabled, i.e. with the CMake option
+    /// \c BOOST_LOCALE_ENABLE_INSTRUMENTATION or the b2 feature \c boost.locale.instrumentation=on.
+    /// Otherwise the code reporting them is not compiled in. All functions may be called concurrently.
+    class BOOST_LOCALE_DECL generation_observer {
+    public:
+        virtual ~generation_observer();
+
+        /// Locale \a id was returned from the cache of a generator or generated concurrently by another call
+        virtual void cache_hit(const std::string& id);
+        /// Locale \a id was not found in the cache of a generator and gets generated
+        virtual void cache_miss(const std::string& id);
+        /// The facets of \a category for \a type were installed for locale \a id, which took \a duration
+        virtual void category_installed(const std::string& id,
+                                        category_t category,
+                                        char_facet_t type,
+                                        std::chrono::nanoseconds duration);
+        /// A message catalog with \a size bytes was loaded from \a file_name
+        virtual void catalog_loaded(const std::string& file_name, size_t size);
+        /// An ICU object of the given \a kind, e.g. "collator" or "number format", was created
+        virtual void icu_object_created(const char* kind);
+    };
+
     /// \brief the major class used for locale generation
     ///
     /// This class is used for specification of all parameters required for locale generation and
@@ -164,11 +200,35 @@ namespace locale {
         void clear_cache();
 
         /// Turn locale caching ON
+        ///
+        /// When enabled concurrent requests for a locale which is not yet cached wait for a single generation.
+        /// Different spellings of the same locale id, e.g. "en-us.utf8" and "en_US.UTF-8", share the cached locale.
+        /// It is generated from the canonical spelling as returned by util::locale_data::to_string, so the result
+        /// doesn't depend on the spelling requested first. So \c info::name returns the canonical spelling, which
+        /// may differ from the name of a locale generated from the same id while the cache is disabled.
         void locale_cache_enabled(bool on);
 
         /// Get locale cache option
         bool locale_cache_enabled() const;
 
+        /// Limit the number of cached locales removing the least recently used ones when exceeded.
+        /// 0 (the default) means no limit.
+        void locale_cache_limit(size_t max_locales);
+
+        /// Get the maximal number of cached locales, 0 if unlimited
+        size_t locale_cache_limit() const;
+
+        /// Get statistics about the use of the locale cache
+        locale_cache_statistics locale_cache_stats() const;
+
+        /// Report the cache hits and misses and the installation of categories of this generator to \a observer
+        /// instead of the global observer, see localization_backend_manager::global_observer.
+        /// A null pointer reports them to the global observer again.
+        void observer(std::shared_ptr<generation_observer> observer);
+
+        /// Get the observer of this generator, null if none is set
+        std::shared_ptr<generation_observer> observer() const;
+
         /// Check if by default ANSI encoding is selected or UTF-8 onces. The default is false.
         bool use_ansi_encoding() const;
 
@@ -179,6 +239,44 @@ namespace locale {
         /// can select "system" one if dealing with legacy applications
         void use_ansi_encoding(bool enc);
 
+        /// Check if message catalogs are mapped into memory rather than read. The default is false.
+        bool use_memory_mapped_catalogs() const;
+
+        /// Map message catalogs read-only into memory instead of reading them into a private buffer
+        /// for each generated locale. See gnu_gettext::messages_info::use_memory_mapping.
+        void use_memory_mapped_catalogs(bool on);
+
+        /// Check if translations of string literals are cached by their address. The default is false.
+        bool cache_literal_lookups() const;
+
+        /// Cache translations of messages created from character pointers by their address.
+        /// See gnu_gettext::messages_info::cache_literal_lookups.
+        void cache_literal_lookups(bool on);
+
+        /// Check if message catalogs are loaded on first use. The default is false.
+        bool lazy_catalog_loading() const;
+
+        /// Load the message catalog of each domain on its first use instead of when generating a locale.
+        /// See gnu_gettext::messages_info::lazy_loading.
+        void lazy_catalog_loading(bool on);
+
+        /// Check if the content of catalog directories is cached. The default is false.
+        bool cache_catalog_directories() const;
+
+        /// Use a process-wide cache of the content of the catalog directories to find message catalogs.
+        /// See gnu_gettext::messages_info::cache_catalog_directories.
+        void cache_catalog_directories(bool on);
+
+        /// Check if facets are shared with other locales of the same backend and locale. The default is false.
+        bool share_facets() const;
+
+        /// Share the facets of all categories except the message category with all other locales generated
+        /// with this option for the same backend and locale instead of creating new ones for each.
+        ///
+        /// The facets are kept in a process-wide table until clear_shared_facets is called. Its size is bounded by
+        /// removing the facets of the least recently generated locales, later locales for those get new facets.
+        void share_facets(bool on);
+
         /// Generate a locale with id \a id
         std::locale generate(const std::string& id) const;
         /// Generate a locale with id \a id. Use \a base as a locale to which all facets are added,
@@ -187,8 +285,27 @@ namespace locale {
         /// Shortcut to generate(id)
         std::locale operator()(const std::string& id) const { return generate(id); }
 
+        /// Function running a task, e.g. by posting it to a thread pool
+        typedef std::function<void(std::function<void()>)> executor_type;
+        /// Function called when a locale was generated by \ref prewarm, \a error is set if that failed
+        typedef std::function<void(const std::string& id, std::exception_ptr error)> prewarm_callback_type;
+
+        /// Generate the locales with the given \a ids in the background and add them to the cache.
+        ///
+        /// A task for each id is passed to \a executor which should run it, usually asynchronously.
+        /// Afterwards \a callback is called, if set, with the id and the exception if the generation failed.
+        /// This allows generating all required locales at startup without delaying it.
+        ///
+        /// \note The locales are only used by \ref generate if the cache is enabled, see \ref locale_cache_enabled.
+        /// The generator must not be destroyed or modified until all tasks have finished.
+        void prewarm(const std::vector<std::string>& ids,
+                     const executor_type& executor,
+                     const prewarm_callback_type& callback = nullptr) const;
+
     private:
         void set_all_options(localization_backend& backend, const std::string& id) const;
+        std::locale create_locale(const std::locale& base, const std::string& id) const;
+        std::locale cached_locale(const std::locale& base, const std::string& id) const;
 
         struct data;
         hold_ptr<data> d;
@@ -11,6 +11,7 @@
 #include <boost/locale/detail/is_supported_char.hpp>
 #include <boost/locale/message.hpp>
 #include <functional>
+#include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <vector>
@@ -27,6 +28,49 @@ namespace boost { namespace locale {
     /// \brief This namespace holds classes that provide GNU Gettext message catalogs support.
     namespace gnu_gettext {
 
+        /// \brief Read-only memory holding the content of a message catalog, e.g. an .mo file
+        ///
+        /// The catalog is used in place without copying it. Depending on how it is created the memory is either:
+        ///
+        /// - owned: When created from a `std::vector<char>`
+        /// - shared: Kept alive by the \a storage which is released when the last facet using the catalog is destroyed.
+        ///   Use a `std::shared_ptr` with a custom deleter to release e.g. a shared memory segment.
+        /// - referenced only: When created via \ref view. The memory must outlive all facets using it.
+        class catalog_buffer {
+        public:
+            /// Create an empty buffer, i.e. a catalog that does not exist
+            catalog_buffer() : data_(nullptr), size_(0) {}
+            /// Take ownership of the catalog content \a data
+            explicit catalog_buffer(std::vector<char> data)
+            {
+                auto storage = std::make_shared<std::vector<char>>(std::move(data));
+                data_ = storage->data();
+                size_ = storage->size();
+                storage_ = std::move(storage);
+            }
+            /// Use the \a size bytes at \a data which are kept valid as long as \a storage is alive
+            catalog_buffer(const char* data, size_t size, std::shared_ptr<const void> storage) :
+                data_(data), size_(size), storage_(std::move(storage))
+            {}
+            /// Use the \a size bytes at \a data without taking ownership.
+            /// The memory must stay valid as long as any facet created from it exists.
+            static catalog_buffer view(const char* data, size_t size) { return catalog_buffer(data, size, nullptr); }
+
+            /// Start of the catalog content
+            const char* data() const { return data_; }
+            /// Size of the catalog content in bytes
+            size_t size() const { return size_; }
+            /// Check if there is no content
+            bool empty() const { return size_ == 0; }
+            /// Access the byte at position \a i
+            const char& operator[](size_t i) const { return data_[i]; }
+
+        private:
+            const char* data_;
+            size_t size_;
+            std::shared_ptr<const void> storage_;
+        };
+
         /// \brief This structure holds all information required for creating gnu-gettext message catalogs,
         ///
         /// The user is expected to set its parameters to load these catalogs correctly. This structure
@@ -34,7 +78,10 @@ namespace boost { namespace locale {
         /// so this structure is not useful for wide characters without subclassing and it will also
         /// ignore gettext catalogs that use a charset different from \a encoding.
         struct BOOST_LOCALE_DECL messages_info {
-            messages_info() : language("C"), locale_category("LC_MESSAGES") {}
+            messages_info() :
+                language("C"), locale_category("LC_MESSAGES"), use_memory_mapping(false), cache_literal_lookups(false),
+                lazy_loading(false), cache_catalog_directories(false)
+            {}
 
             std::string language; ///< The language we load the catalog for, like "ru", "en", "de"
             std::string country;  ///< The country we load the catalog for, like "US", "IL"
@@ -99,6 +146,55 @@ namespace boost { namespace locale {
             /// is being used.
             callback_type callback;
 
+            /// The callback for custom catalog storage which avoids copying the catalog. This callback should
+            /// return the content of the file named \a file_name encoded in \a encoding character set as a
+            /// catalog_buffer which is used in place.
+            ///
+            /// - If the file does not exist, it should return an empty buffer.
+            /// - If an error occurs during the file access it should throw an exception.
+            ///
+            /// This is useful for catalogs which are already in memory, e.g. embedded resources or shared memory.
+            typedef std::function<catalog_buffer(const std::string& file_name, const std::string& encoding)>
+              buffer_callback_type;
+
+            /// The callback for handling custom catalog storage. If set it is used instead of \a callback.
+            buffer_callback_type buffer_callback;
+
+            /// Map the catalog files read-only into memory instead of reading them into a private buffer.
+            ///
+            /// The pages are shared between all processes using the same catalogs and only loaded on access.
+            /// Ignored if a \a callback or \a buffer_callback is set.
+            ///
+            /// \note The catalog files must not be modified while they are in use, i.e. replace them instead.
+            bool use_memory_mapping;
+
+            /// Cache the translations of messages created from character pointers by the addresses of those.
+            ///
+            /// This avoids the catalog lookup for repeated translations of the same string literals.
+            ///
+            /// \note All messages created from character pointers, e.g. by \ref translate, must then point to
+            /// immutable strings with static storage duration like string literals.
+            bool cache_literal_lookups;
+
+            /// Locate and load the catalog of each domain on its first lookup instead of on facet creation.
+            ///
+            /// This makes creating the facet cheap when many domains are registered but only some are used.
+            ///
+            /// \note Errors while loading a catalog, e.g. an invalid file, are then reported by the lookup.
+            /// The error is reported again by later lookups in that domain without reading the catalog again,
+            /// until reload_messages_catalogs is called.
+            bool lazy_loading;
+
+            /// Check for the existence of catalog files in a process-wide cache of the content of the catalog
+            /// directories instead of trying to open every possible file.
+            ///
+            /// This avoids many failing file system accesses, e.g. for locales with country and variant.
+            /// Ignored if a \a callback or \a buffer_callback is set.
+            /// At most 256 directories are cached, the cache is started over when more are used.
+            ///
+            /// \note Call \ref clear_catalog_directory_cache when catalog files were added or removed.
+            bool cache_catalog_directories;
+
             /// Get paths to folders which may contain catalog files
             std::vector<std::string> get_catalog_paths() const;
 
@@ -112,6 +208,41 @@ namespace boost { namespace locale {
         template<typename CharType, class = boost::locale::detail::enable_if_is_supported_char<CharType>>
         BOOST_LOCALE_DECL message_format<CharType>* create_messages_facet(const messages_info& info);
 
+        /// Reload the catalogs of the message_format facet of \a loc which changed since they were loaded.
+        ///
+        /// This allows using updated catalogs without generating new locales. A catalog file is considered changed
+        /// when its modification time (with sub-second resolution where available), size or identity (e.g. the inode
+        /// after replacing it by renaming another file) differs or when another file would be found now.
+        /// Catalogs provided by a callback are reloaded when the returned content differs from the loaded one.
+        /// Lookups are not blocked and continue to use the previous catalog until the new one is loaded.
+        /// Call it periodically or when catalogs were updated.
+        ///
+        /// \note Replaced catalogs are kept in memory until the facet is destroyed as previously returned
+        /// translations may still be in use. So each reload which replaces a catalog increases the memory used by
+        /// the facet by the size of the old catalog. Processes whose catalogs change often should generate new
+        /// locales from time to time to release them.
+        ///
+        /// \return true if any catalog was reloaded, false if none changed or the facet of \a loc
+        /// was not created by create_messages_facet
+        template<typename CharType, class = boost::locale::detail::enable_if_is_supported_char<CharType>>
+        BOOST_LOCALE_DECL bool reload_messages_catalogs(const std::locale& loc);
+
+        /// Clear the cache of the content of catalog directories used with
+        /// messages_info::cache_catalog_directories, so added or removed catalogs are found by facets created
+        /// or reloaded afterwards.
+        BOOST_LOCALE_DECL void clear_catalog_directory_cache();
+
+        /// Prepare the message catalog \a catalog, i.e. the content of a .mo file, for locales using \a encoding.
+        ///
+        /// The result is a .mo file with all strings converted to \a encoding and a hash table. Facets for such
+        /// locales can use it in place without conversion or indexing, especially when it is memory mapped.
+        /// Storing the prepared catalogs once, e.g. on deployment, avoids repeating this work in every process.
+        ///
+        /// \throws std::runtime_error if \a catalog is invalid
+        /// \throws conv::invalid_charset_error if the conversion to \a encoding is not supported
+        /// \throws conv::conversion_error if any string can't be represented in \a encoding
+        BOOST_LOCALE_DECL std::vector<char> prepare_catalog(catalog_buffer catalog, const std::string& encoding);
+
     } // namespace gnu_gettext
 
     /// @}
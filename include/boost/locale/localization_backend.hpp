@@ -34,6 +34,13 @@ namespace boost { namespace locale {
     ///     by default
     /// -# \c message_path - path to the location of message catalogs (vector of strings)
     /// -# \c message_application - the name of applications that use message catalogs (vector of strings)
+    /// -# \c message_memory_mapping - map message catalogs into memory instead of reading them ("true" or "false")
+    /// -# \c message_cache_literal_lookups - cache translations by the address of the message strings ("true" or
+    ///     "false")
+    /// -# \c message_lazy_loading - load message catalogs on first use ("true" or "false")
+    /// -# \c message_cache_directories - cache the content of the catalog directories ("true" or "false")
+    /// -# \c share_facets - share the facets of all categories but messages with all locales for which the option
+    ///     is set and which use the same locale ("true" or "false")
     ///
     /// Each backend can be installed with a different default priority so when you work with two different backends,
     /// you can specify priority so this backend will be chosen according to their priority.
@@ -115,11 +122,28 @@ namespace boost { namespace locale {
         /// This function is thread safe
         static localization_backend_manager global();
 
+        /// Set the observer of the events of all locale generations which are not reported to the observer of a
+        /// \ref generator, e.g. loaded message catalogs. The old one is returned.
+        ///
+        /// Events are reported to the new observer right after this returns. Reporting an event does not take the lock
+        /// of this function, so threads may keep a reference to a replaced observer until they report their next event.
+        ///
+        /// This function is thread safe
+        static std::shared_ptr<generation_observer> global_observer(std::shared_ptr<generation_observer> observer);
+        /// Get the global observer, null if none is set
+        ///
+        /// This function is thread safe
+        static std::shared_ptr<generation_observer> global_observer();
+
     private:
         class impl;
         hold_ptr<impl> pimpl_;
     };
 
+    /// Remove all facets shared between locales generated with the \c share_facets option from the table they
+    /// are kept in. Locales using them are unaffected, but locales generated afterwards get new facets.
+    BOOST_LOCALE_DECL void clear_shared_facets();
+
 }} // namespace boost::locale
 
 #ifdef BOOST_MSVC
@@ -90,6 +90,23 @@ namespace boost { namespace locale {
         /// Note: for char_type that is char16_t, char32_t and wchar_t it is no-op, returns
         /// msg
         virtual const char_type* convert(const char_type* msg, string_type& buffer) const = 0;
+
+        /// Same as \ref get(int, const char_type*, const char_type*) const "get" but \a context and \a id are
+        /// character pointers given to \ref basic_message. If enabled for the facet, they are assumed to point to
+        /// immutable strings with static storage duration (e.g. string literals) and the result may be cached by
+        /// their address.
+        virtual const char_type* get_literal(int domain_id, const char_type* context, const char_type* id) const
+        {
+            return get(domain_id, context, id);
+        }
+
+        /// Same as \ref get(int, const char_type*, const char_type*, count_type) const "get" but \a context and
+        /// \a single_id are character pointers given to \ref basic_message, see \ref get_literal
+        virtual const char_type*
+        get_literal(int domain_id, const char_type* context, const char_type* single_id, count_type n) const
+        {
+            return get(domain_id, context, single_id, n);
+        }
     };
 
     /// \cond INTERNAL
@@ -309,10 +326,19 @@ namespace boost { namespace locale {
 
             const char_type* translated = nullptr;
             if(facet) {
-                if(!plural)
-                    translated = facet->get(domain_id, context, id);
-                else
-                    translated = facet->get(domain_id, context, id, n_);
+                // Only the strings passed by pointer may be cached by their address
+                const bool is_literal = c_id_ && (c_context_ || !context);
+                if(!plural) {
+                    if(is_literal)
+                        translated = facet->get_literal(domain_id, context, id);
+                    else
+                        translated = facet->get(domain_id, context, id);
+                } else {
+                    if(is_literal)
+                        translated = facet->get_literal(domain_id, context, id, n_);
+                    else
+                        translated = facet->get(domain_id, context, id, n_);
+                }
             }
 
             if(!translated) {
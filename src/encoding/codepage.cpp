@@ -6,7 +6,14 @@
 // https://www.boost.org/LICENSE_1_0.txt
 
 #include <boost/locale/encoding.hpp>
+#include <boost/thread/tss.hpp>
+#include "../util/encoding.hpp"
 #include "../util/make_std_unique.hpp"
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #if BOOST_LOCALE_USE_WIN32_API
 #    define BOOST_LOCALE_WITH_WCONV
@@ -20,8 +27,64 @@
 #ifdef BOOST_LOCALE_WITH_WCONV
 #    include "wconv_converter.hpp"
 #endif
+#include "utf_stream_converter.hpp"
 
 namespace boost { namespace locale { namespace conv {
+    namespace {
+        /// Small per-thread cache of opened converters used by \ref to_utf, \ref from_utf and \ref between
+        ///
+        /// Opening a converter (iconv_open, ucnv_open, ...) is much more expensive than converting a short text.
+        /// A converter is only used by the thread which opened it and each conversion starts from the initial
+        /// state of the converter, so it can be reused for all later conversions with the same parameters.
+        template<class Converter>
+        class converter_cache {
+        public:
+            static constexpr size_t max_size = 8;
+
+            template<class Creator>
+            Converter& get(const std::string& to_charset,
+                           const std::string& from_charset,
+                           const method_type how,
+                           Creator create)
+            {
+                entries_type* entries = entries_.get();
+                if(!entries) {
+                    entries = new entries_type();
+                    entries_.reset(entries);
+                }
+                const auto it = std::find_if(entries->begin(), entries->end(), [&](const entry& e) {
+                    return e.how == how && e.to_charset == to_charset && e.from_charset == from_charset;
+                });
+                if(it != entries->end()) {
+                    // Keep the most recently used converters at the front and evict from the back
+                    std::rotate(entries->begin(), it, it + 1);
+                } else {
+                    entry e{to_charset, from_charset, how, create()};
+                    if(entries->size() >= max_size)
+                        entries->pop_back();
+                    entries->insert(entries->begin(), std::move(e));
+                }
+                return *entries->front().converter;
+            }
+
+        private:
+            struct entry {
+                std::string to_charset;
+                std::string from_charset;
+                method_type how;
+                std::unique_ptr<Converter> converter;
+            };
+            using entries_type = std::vector<entry>;
+            boost::thread_specific_ptr<entries_type> entries_;
+        };
+
+        template<class Converter>
+        converter_cache<Converter>& cached_converters()
+        {
+            static converter_cache<Converter> cache;
+            return cache;
+        }
+    } // namespace
 
     std::string between(const char* begin,
                         const char* end,
@@ -29,82 +92,26 @@ namespace boost { namespace locale { namespace conv {
                         const std::string& from_charset,
                         method_type how)
     {
-#ifdef BOOST_LOCALE_WITH_ICONV
-        {
-            impl::iconv_between cvt;
-            if(cvt.open(to_charset, from_charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-#ifdef BOOST_LOCALE_WITH_ICU
-        {
-            impl::uconv_between cvt;
-            if(cvt.open(to_charset, from_charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-#ifdef BOOST_LOCALE_WITH_WCONV
-        {
-            impl::wconv_between cvt;
-            if(cvt.open(to_charset, from_charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-        throw invalid_charset_error(std::string(to_charset) + " or " + from_charset);
+        auto& cvt = cached_converters<detail::narrow_converter>().get(to_charset, from_charset, how, [&]() {
+            return detail::make_narrow_converter(from_charset, to_charset, how);
+        });
+        return cvt.convert(begin, end);
     }
 
     template<typename CharType>
     std::basic_string<CharType> to_utf(const char* begin, const char* end, const std::string& charset, method_type how)
     {
-#ifdef BOOST_LOCALE_WITH_ICONV
-        {
-            impl::iconv_to_utf<CharType> cvt;
-            if(cvt.open(charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-#ifdef BOOST_LOCALE_WITH_ICU
-        {
-            impl::uconv_to_utf<CharType> cvt;
-            if(cvt.open(charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-#ifdef BOOST_LOCALE_WITH_WCONV
-        {
-            impl::wconv_to_utf<CharType> cvt;
-            if(cvt.open(charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-        throw invalid_charset_error(charset);
+        auto& cvt = cached_converters<detail::utf_encoder<CharType>>().get(
+          util::utf_name<CharType>(), charset, how, [&]() { return detail::make_utf_encoder<CharType>(charset, how); });
+        return cvt.convert(begin, end);
     }
 
     template<typename CharType>
     std::string from_utf(const CharType* begin, const CharType* end, const std::string& charset, method_type how)
     {
-#ifdef BOOST_LOCALE_WITH_ICONV
-        {
-            impl::iconv_from_utf<CharType> cvt;
-            if(cvt.open(charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-#ifdef BOOST_LOCALE_WITH_ICU
-        {
-            impl::uconv_from_utf<CharType> cvt;
-            if(cvt.open(charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-#ifdef BOOST_LOCALE_WITH_WCONV
-        {
-            impl::wconv_from_utf<CharType> cvt;
-            if(cvt.open(charset, how))
-                return cvt.convert(begin, end);
-        }
-#endif
-        throw invalid_charset_error(charset);
+        auto& cvt = cached_converters<detail::utf_decoder<CharType>>().get(
+          charset, util::utf_name<CharType>(), how, [&]() { return detail::make_utf_decoder<CharType>(charset, how); });
+        return cvt.convert(begin, end);
     }
 
     namespace detail {
@@ -197,6 +204,50 @@ namespace boost { namespace locale { namespace conv {
 #endif
             throw invalid_charset_error(std::string(src_encoding) + " or " + target_encoding);
         }
+
+        /// Encoding to use for \a Char when \a encoding was requested
+        template<typename Char>
+        std::string stream_encoding(const std::string& encoding)
+        {
+            return std::is_same<Char, char>::value ? encoding : util::utf_name<Char>();
+        }
+
+        template<typename Char>
+        bool is_utf_encoding(const std::string& encoding)
+        {
+            return util::normalize_encoding(encoding) == util::normalize_encoding(util::utf_name<Char>());
+        }
+
+        template<typename CharIn, typename CharOut>
+        std::unique_ptr<stream_converter<CharIn, CharOut>> make_stream_converter(const std::string& src_encoding,
+                                                                                const std::string& target_encoding,
+                                                                                method_type how,
+                                                                                conv_backend impl)
+        {
+            const std::string from = stream_encoding<CharIn>(src_encoding);
+            const std::string to = stream_encoding<CharOut>(target_encoding);
+            if(impl == conv_backend::Default && is_utf_encoding<CharIn>(from) && is_utf_encoding<CharOut>(to))
+                return make_std_unique<impl::utf_stream_converter<CharIn, CharOut>>(how);
+#ifdef BOOST_LOCALE_WITH_ICONV
+            if(impl == conv_backend::Default || impl == conv_backend::IConv) {
+                impl::iconv_stream_converter<CharIn, CharOut> cvt;
+                if(cvt.open(to, from, how))
+                    return move_to_ptr(cvt);
+            }
+#endif
+#ifdef BOOST_LOCALE_WITH_ICU
+            if(impl == conv_backend::Default || impl == conv_backend::ICU) {
+                // Not movable as it points into its own pivot buffer
+                std::unique_ptr<stream_converter<CharIn, CharOut>> result;
+                auto* cvt = new impl::uconv_stream_converter<CharIn, CharOut>();
+                result.reset(cvt);
+                if(cvt->open(to, from, how))
+                    return result;
+            }
+#endif
+            // The WinAPI can't keep incomplete sequences between calls
+            throw invalid_charset_error(std::string(src_encoding) + " or " + target_encoding);
+        }
     } // namespace detail
 
 #define BOOST_LOCALE_INSTANTIATE(CHARTYPE)                                                              \
@@ -206,6 +257,12 @@ namespace boost { namespace locale { namespace conv {
         make_utf_encoder(const std::string& charset, method_type how, conv_backend impl);               \
         template BOOST_LOCALE_DECL std::unique_ptr<utf_decoder<CHARTYPE>>                               \
         make_utf_decoder(const std::string& charset, method_type how, conv_backend impl);               \
+        template class stream_converter<char, CHARTYPE>;                                                \
+        template BOOST_LOCALE_DECL std::unique_ptr<stream_converter<char, CHARTYPE>>                    \
+        make_stream_converter<char, CHARTYPE>(const std::string& src_encoding,                          \
+                                              const std::string& target_encoding,                       \
+                                              method_type how,                                          \
+                                              conv_backend impl);                                       \
     }                                                                                                   \
     template BOOST_LOCALE_DECL std::basic_string<CHARTYPE> to_utf<CHARTYPE>(const char* begin,          \
                                                                             const char* end,            \
@@ -215,10 +272,16 @@ namespace boost { namespace locale { namespace conv {
                                                               const CHARTYPE* end,                      \
                                                               const std::string& charset,               \
                                                               method_type how)
-#define BOOST_LOCALE_INSTANTIATE_NO_CHAR(CHARTYPE)        \
-    BOOST_LOCALE_INSTANTIATE(CHARTYPE);                   \
-    namespace detail {                                    \
-        template class charset_converter<CHARTYPE, char>; \
+#define BOOST_LOCALE_INSTANTIATE_NO_CHAR(CHARTYPE)                                               \
+    BOOST_LOCALE_INSTANTIATE(CHARTYPE);                                                          \
+    namespace detail {                                                                           \
+        template class charset_converter<CHARTYPE, char>;                                        \
+        template class stream_converter<CHARTYPE, char>;                                         \
+        template BOOST_LOCALE_DECL std::unique_ptr<stream_converter<CHARTYPE, char>>             \
+        make_stream_converter<CHARTYPE, char>(const std::string& src_encoding,                   \
+                                              const std::string& target_encoding,                \
+                                              method_type how,                                   \
+                                              conv_backend impl);                                \
     }
 
     BOOST_LOCALE_INSTANTIATE(char);
@@ -29,24 +29,72 @@ namespace boost { namespace locale { namespace conv { namespace impl {
         std::basic_string<OutChar> real_convert(const InChar* ubegin, const InChar* uend)
         {
             std::basic_string<OutChar> sresult;
+            real_convert(ubegin, uend, sresult);
+            return sresult;
+        }
+
+        template<typename OutChar, typename InChar>
+        size_t real_convert(const InChar* ubegin, const InChar* uend, std::basic_string<OutChar>& sresult)
+        {
+            // Start from the initial shift state even if a previous conversion was aborted
+            reset();
+            const size_t old_size = sresult.size();
+            try {
+                append_converted(ubegin, uend, sresult, true);
+            } catch(...) {
+                sresult.resize(old_size);
+                throw;
+            }
+            return sresult.size() - old_size;
+        }
+
+        /// Convert a chunk of a text keeping the shift state. Unless it is the \a last chunk an incomplete
+        /// sequence at the end is not converted. Return the start of that sequence.
+        template<typename OutChar, typename InChar>
+        const InChar*
+        stream_convert(const InChar* ubegin, const InChar* uend, std::basic_string<OutChar>& sresult, bool last)
+        {
+            const size_t old_size = sresult.size();
+            try {
+                return append_converted(ubegin, uend, sresult, last);
+            } catch(...) {
+                sresult.resize(old_size);
+                throw;
+            }
+        }
 
-            sresult.reserve(uend - ubegin);
+        void reset() { conv(nullptr, nullptr, nullptr, nullptr); }
 
-            OutChar tmp_buf[64];
+    private:
+        /// Room (in output characters) for any single converted character including shift sequences
+        static constexpr size_t min_free_space = 16;
 
-            char* out_start = reinterpret_cast<char*>(tmp_buf);
+        template<typename OutChar, typename InChar>
+        const InChar*
+        append_converted(const InChar* ubegin, const InChar* uend, std::basic_string<OutChar>& sresult, bool last)
+        {
             const char* begin = reinterpret_cast<const char*>(ubegin);
             const char* end = reinterpret_cast<const char*>(uend);
 
+            // Convert directly into the result. Start with room for one output character per input character
+            // (exact for most texts) and grow it by the size of the remaining input whenever IConv runs out of it.
+            size_t used = sresult.size();
+
             bool is_unshifting = false;
 
             for(;;) {
                 size_t in_left = end - begin;
-                size_t out_left = sizeof(tmp_buf);
+                if(sresult.size() - used < min_free_space)
+                    sresult.resize(used + in_left / sizeof(InChar) + min_free_space);
+                char* out_start = reinterpret_cast<char*>(&sresult[used]);
+                size_t out_left = (sresult.size() - used) * sizeof(OutChar);
                 char* out_ptr = out_start;
 
-                if(in_left == 0)
+                if(in_left == 0) {
+                    if(!last)
+                        break;
                     is_unshifting = true;
+                }
 
                 const auto old_in_left = in_left;
                 const size_t res = (!is_unshifting) ? conv(&begin, &in_left, &out_ptr, &out_left) :
@@ -57,12 +105,13 @@ namespace boost { namespace locale { namespace conv { namespace impl {
                         throw conversion_error();
                 }
 
-                const size_t output_count = (out_ptr - out_start) / sizeof(OutChar);
-                sresult.append(tmp_buf, output_count);
+                used += (out_ptr - out_start) / sizeof(OutChar);
 
                 if(res == (size_t)(-1)) {
                     const int err = errno;
                     BOOST_ASSERT_MSG(err == EILSEQ || err == EINVAL || err == E2BIG, "Invalid error code from IConv");
+                    if(err == EINVAL && !last)
+                        break; // Incomplete sequence at the end, wait for the next chunk
                     if(err == EILSEQ || err == EINVAL) {
                         if(how_ == stop)
                             throw conversion_error();
@@ -74,19 +123,22 @@ namespace boost { namespace locale { namespace conv { namespace impl {
                         } else
                             break;
                     } else if(err == E2BIG) {
-                        if(in_left != old_in_left || out_ptr != out_start) // Check to avoid infinite loop
-                            continue;
-                        throw std::runtime_error("No progress, IConv is faulty!"); // LCOV_EXCL_LINE
+                        // There was always room for at least min_free_space characters, so check for progress
+                        // to avoid an infinite loop
+                        if(in_left == old_in_left && out_ptr == out_start)
+                            throw std::runtime_error("No progress, IConv is faulty!"); // LCOV_EXCL_LINE
+                        sresult.resize(sresult.size() + in_left / sizeof(InChar) + min_free_space);
+                        continue;
                     } else                        // Invalid error code, shouldn't ever happen or iconv has a bug
                         throw conversion_error(); // LCOV_EXCL_LINE
                 }
                 if(is_unshifting)
                     break;
             }
-            return sresult;
+            sresult.resize(used);
+            return reinterpret_cast<const InChar*>(begin);
         }
 
-    private:
         size_t conv(const char** inbuf, size_t* inchar_left, char** outbuf, size_t* outchar_left)
         {
             return call_iconv(cvt_, inbuf, inchar_left, outbuf, outchar_left);
@@ -109,6 +161,12 @@ namespace boost { namespace locale { namespace conv { namespace impl {
             return self_.template real_convert<char>(ubegin, uend);
         }
 
+    protected:
+        size_t do_append(const CharType* ubegin, const CharType* uend, std::string& out) override
+        {
+            return self_.real_convert(ubegin, uend, out);
+        }
+
     private:
         iconverter_base self_;
     };
@@ -124,6 +182,12 @@ namespace boost { namespace locale { namespace conv { namespace impl {
             return self_.real_convert<char, char>(begin, end);
         }
 
+    protected:
+        size_t do_append(const char* begin, const char* end, std::string& out) override
+        {
+            return self_.real_convert(begin, end, out);
+        }
+
     private:
         iconverter_base self_;
     };
@@ -141,8 +205,60 @@ namespace boost { namespace locale { namespace conv { namespace impl {
             return self_.template real_convert<CharType>(begin, end);
         }
 
+    protected:
+        size_t do_append(const char* begin, const char* end, std::basic_string<CharType>& out) override
+        {
+            return self_.real_convert(begin, end, out);
+        }
+
+    private:
+        iconverter_base self_;
+    };
+
+    template<typename CharIn, typename CharOut>
+    class iconv_stream_converter final : public detail::stream_converter<CharIn, CharOut> {
+    public:
+        bool open(const std::string& to_charset, const std::string& from_charset, method_type how)
+        {
+            return self_.do_open(to_charset.c_str(), from_charset.c_str(), how);
+        }
+
+        size_t convert(const CharIn* begin, const CharIn* end, std::basic_string<CharOut>& out, bool last) override
+        {
+            const size_t old_size = out.size();
+            try {
+                // Complete the character started in the previous chunk by moving single units from this one
+                while(!pending_.empty() && begin != end) {
+                    pending_ += *begin++;
+                    const CharIn* data = pending_.data();
+                    const CharIn* rest = self_.stream_convert(data, data + pending_.size(), out, false);
+                    pending_.erase(0, rest - data);
+                }
+                if(pending_.empty())
+                    pending_.assign(self_.stream_convert(begin, end, out, last), end);
+                else if(last) {
+                    const CharIn* data = pending_.data();
+                    self_.stream_convert(data, data + pending_.size(), out, true);
+                }
+            } catch(...) {
+                out.resize(old_size);
+                reset();
+                throw;
+            }
+            if(last)
+                reset();
+            return out.size() - old_size;
+        }
+
+        void reset() override
+        {
+            self_.reset();
+            pending_.clear();
+        }
+
     private:
         iconverter_base self_;
+        std::basic_string<CharIn> pending_;
     };
 
 }}}} // namespace boost::locale::conv::impl
@@ -115,6 +115,100 @@ namespace boost { namespace locale { namespace conv { namespace impl {
         hold_ptr<to_type> cvt_to_;
     };
 
+    template<typename CharIn, typename CharOut>
+    class uconv_stream_converter final : public detail::stream_converter<CharIn, CharOut> {
+    public:
+        bool open(const std::string& to_charset, const std::string& from_charset, method_type how)
+        {
+            try {
+                using impl_icu::cpcvt_type;
+                cvt_from_.reset(new impl_icu::uconv(from_charset, how == skip ? cpcvt_type::skip : cpcvt_type::stop));
+                cvt_to_.reset(new impl_icu::uconv(to_charset, how == skip ? cpcvt_type::skip : cpcvt_type::stop));
+            } catch(const std::exception& /*e*/) {
+                cvt_from_.reset();
+                cvt_to_.reset();
+                return false;
+            }
+            reset_pivot();
+            return true;
+        }
+
+        size_t convert(const CharIn* begin, const CharIn* end, std::basic_string<CharOut>& out, bool last) override
+        {
+            const size_t old_size = out.size();
+            try {
+                append_converted(begin, end, out, last);
+            } catch(...) {
+                out.resize(old_size);
+                reset();
+                throw;
+            }
+            if(last)
+                reset();
+            return out.size() - old_size;
+        }
+
+        void reset() override
+        {
+            ucnv_reset(cvt_from_->cvt());
+            ucnv_reset(cvt_to_->cvt());
+            reset_pivot();
+        }
+
+    private:
+        /// Room (in output characters) for any single converted character including shift sequences
+        static constexpr size_t min_free_space = 16;
+
+        void append_converted(const CharIn* begin, const CharIn* end, std::basic_string<CharOut>& out, bool last)
+        {
+            // Incomplete input and shift states are kept by the ICU converters and the pivot buffer as long as
+            // neither reset nor flush are requested
+            const char* source = reinterpret_cast<const char*>(begin);
+            const char* source_end = reinterpret_cast<const char*>(end);
+            if(!source)
+                source = source_end = ""; // ICU doesn't accept a NULL source even if it is empty
+            size_t used = out.size();
+            for(;;) {
+                if(out.size() - used < min_free_space)
+                    out.resize(used + (source_end - source) / sizeof(CharIn) + min_free_space);
+                char* target = reinterpret_cast<char*>(&out[used]);
+                char* const target_start = target;
+                char* const target_end = reinterpret_cast<char*>(&out[0] + out.size());
+                UErrorCode err = U_ZERO_ERROR;
+                ucnv_convertEx(cvt_to_->cvt(),
+                               cvt_from_->cvt(),
+                               &target,
+                               target_end,
+                               &source,
+                               source_end,
+                               pivot_,
+                               &pivot_source_,
+                               &pivot_target_,
+                               pivot_ + pivot_size,
+                               false,
+                               last,
+                               &err);
+                used += (target - target_start) / sizeof(CharOut);
+                if(err == U_BUFFER_OVERFLOW_ERROR)
+                    out.resize(out.size() + (source_end - source) / sizeof(CharIn) + min_free_space);
+                else if(U_FAILURE(err))
+                    throw conversion_error();
+                else
+                    break;
+            }
+            out.resize(used);
+        }
+
+        void reset_pivot() { pivot_source_ = pivot_target_ = pivot_; }
+
+        static constexpr size_t pivot_size = 256;
+        UChar pivot_[pivot_size];
+        UChar* pivot_source_;
+        UChar* pivot_target_;
+        hold_ptr<impl_icu::uconv> cvt_from_;
+        hold_ptr<impl_icu::uconv> cvt_to_;
+    };
+
 }}}} // namespace boost::locale::conv::impl
 
 #endif
@@ -0,0 +1,75 @@
+//
+// Copyright (c) 2025 Alexander Grund
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_LOCALE_IMPL_UTF_STREAM_CONVERTER_HPP
+#define BOOST_LOCALE_IMPL_UTF_STREAM_CONVERTER_HPP
+
+#include <boost/locale/encoding.hpp>
+#include <boost/locale/utf.hpp>
+#include <iterator>
+#include <string>
+
+namespace boost { namespace locale { namespace conv { namespace impl {
+
+    /// Builtin stream converter between UTF encodings which doesn't need IConv or ICU
+    template<typename CharIn, typename CharOut>
+    class utf_stream_converter final : public detail::stream_converter<CharIn, CharOut> {
+    public:
+        explicit utf_stream_converter(method_type how) : how_(how) {}
+
+        size_t convert(const CharIn* begin, const CharIn* end, std::basic_string<CharOut>& out, bool last) override
+        {
+            const size_t old_size = out.size();
+            try {
+                // Complete the character started in the previous chunk by moving single units from this one
+                while(!pending_.empty() && begin != end) {
+                    pending_ += *begin++;
+                    const CharIn* const rest = decode(pending_.data(), pending_.data() + pending_.size(), out, false);
+                    pending_.erase(0, rest - pending_.data());
+                }
+                if(pending_.empty())
+                    pending_.assign(decode(begin, end, out, last), end);
+                else if(last) {
+                    decode(pending_.data(), pending_.data() + pending_.size(), out, true);
+                    pending_.clear();
+                }
+            } catch(...) {
+                out.resize(old_size);
+                reset();
+                throw;
+            }
+            return out.size() - old_size;
+        }
+
+        void reset() override { pending_.clear(); }
+
+    private:
+        /// Append the characters in [begin, end) to \a out.
+        /// Return the start of an incomplete character at the end which is kept for the next chunk unless \a last
+        const CharIn* decode(const CharIn* begin, const CharIn* end, std::basic_string<CharOut>& out, bool last) const
+        {
+            auto inserter = std::back_inserter(out);
+            while(begin != end) {
+                const CharIn* const start = begin;
+                const utf::code_point c = utf::utf_traits<CharIn>::decode(begin, end);
+                if(c == utf::incomplete && !last)
+                    return start;
+                if(c == utf::illegal || c == utf::incomplete) {
+                    if(how_ == stop)
+                        throw conversion_error();
+                } else
+                    utf::utf_traits<CharOut>::encode(c, inserter);
+            }
+            return end;
+        }
+
+        method_type how_;
+        std::basic_string<CharIn> pending_;
+    };
+
+}}}} // namespace boost::locale::conv::impl
+
+#endif
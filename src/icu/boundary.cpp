@@ -7,6 +7,7 @@
 
 #include <boost/locale/boundary.hpp>
 #include <boost/locale/generator.hpp>
+#include "../shared/instrumentation.hpp"
 #include "../util/encoding.hpp"
 #include "all_generator.hpp"
 #include "cdata.hpp"
@@ -122,6 +123,7 @@ namespace boost { namespace locale {
             check_and_throw_icu_error(err);
             if(!bi)
                 throw std::runtime_error("Failed to create break iterator");
+            locale::detail::instrumentation().icu_object_created("break iterator");
             return bi;
         }
 
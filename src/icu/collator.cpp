@@ -7,6 +7,7 @@
 
 #include <boost/locale/collator.hpp>
 #include <boost/locale/generator.hpp>
+#include "../shared/instrumentation.hpp"
 #include "../shared/mo_hash.hpp"
 #include "../shared/std_collate_adapter.hpp"
 #include "all_generator.hpp"
@@ -137,6 +138,7 @@ namespace boost { namespace locale { namespace impl_icu {
                 std::unique_ptr<icu::Collator> tmp_col(icu::Collator::createInstance(locale_, status));
                 if(U_FAILURE(status))
                     throw std::runtime_error(std::string("Creation of collate failed:") + u_errorName(status));
+                detail::instrumentation().icu_object_created("collator");
 
                 tmp_col->setStrength(levels[lvl_idx]);
                 col = tmp_col.release();
@@ -6,6 +6,7 @@
 // https://www.boost.org/LICENSE_1_0.txt
 
 #include <boost/locale/conversion.hpp>
+#include "../shared/instrumentation.hpp"
 #include "all_generator.hpp"
 #include "cdata.hpp"
 #include "icu_util.hpp"
@@ -102,6 +103,7 @@ namespace boost { namespace locale { namespace impl_icu {
             check_and_throw_icu_error(err);
             if(!map_)
                 throw std::runtime_error("Failed to create UCaseMap"); // LCOV_EXCL_LINE
+            detail::instrumentation().icu_object_created("case map");
         }
         ~raii_casemap() { ucasemap_close(map_); }
 
@@ -9,6 +9,7 @@
 #include <boost/locale/date_time_facet.hpp>
 #include <boost/locale/formatting.hpp>
 #include <boost/locale/hold_ptr.hpp>
+#include "../shared/instrumentation.hpp"
 #include "all_generator.hpp"
 #include "cdata.hpp"
 #include "icu_util.hpp"
@@ -67,6 +68,7 @@ namespace boost { namespace locale { namespace impl_icu {
             const double rounded_time = std::floor(calendar_->getTime(err) / U_MILLIS_PER_SECOND) * U_MILLIS_PER_SECOND;
             calendar_->setTime(rounded_time, err);
             check_and_throw_dt(err);
+            detail::instrumentation().icu_object_created("calendar");
             encoding_ = dat.encoding();
         }
         calendar_impl(const calendar_impl& other)
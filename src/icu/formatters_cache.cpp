@@ -6,6 +6,7 @@
 // https://www.boost.org/LICENSE_1_0.txt
 
 #include "formatters_cache.hpp"
+#include "../shared/instrumentation.hpp"
 #include <boost/assert.hpp>
 #include <boost/core/ignore_unused.hpp>
 #include <memory>
@@ -107,6 +108,7 @@ namespace boost { namespace locale { namespace impl_icu {
             check_and_throw_icu_error(err, "Failed to create a formatter");
             result = new_ptr.get();
             BOOST_ASSERT(result);
+            detail::instrumentation().icu_object_created("number format");
             number_format_[int(type)].reset(new_ptr.release());
         }
         return *result;
@@ -123,6 +125,7 @@ namespace boost { namespace locale { namespace impl_icu {
             if(result) {
                 fmt.release();
                 date_formatter_.reset(result);
+                detail::instrumentation().icu_object_created("date format");
             }
         }
         return result;
@@ -9,20 +9,22 @@
 #include <boost/locale/gnu_gettext.hpp>
 #include <boost/locale/localization_backend.hpp>
 #include <boost/locale/util.hpp>
+#include "../shared/facet_table.hpp"
 #include "../shared/message.hpp"
 #include "../util/make_std_unique.hpp"
 #include "all_generator.hpp"
 #include "cdata.hpp"
+#include "formatters_cache.hpp"
 
 #include <unicode/ucnv.h>
 
 namespace boost { namespace locale { namespace impl_icu {
     class icu_localization_backend : public localization_backend {
     public:
-        icu_localization_backend() : invalid_(true), use_ansi_encoding_(false) {}
+        icu_localization_backend() : invalid_(true), use_ansi_encoding_(false), share_facets_(false) {}
         icu_localization_backend(const icu_localization_backend& other) :
-            localization_backend(), paths_(other.paths_), domains_(other.domains_), locale_id_(other.locale_id_),
-            invalid_(true), use_ansi_encoding_(other.use_ansi_encoding_)
+            localization_backend(), messages_(other.messages_), locale_id_(other.locale_id_),
+            invalid_(true), use_ansi_encoding_(other.use_ansi_encoding_), share_facets_(other.share_facets_)
         {}
         icu_localization_backend* clone() const override { return new icu_localization_backend(*this); }
 
@@ -31,20 +33,20 @@ namespace boost { namespace locale { namespace impl_icu {
             invalid_ = true;
             if(name == "locale")
                 locale_id_ = value;
-            else if(name == "message_path")
-                paths_.push_back(value);
-            else if(name == "message_application")
-                domains_.push_back(value);
             else if(name == "use_ansi_encoding")
                 use_ansi_encoding_ = value == "true";
+            else if(name == "share_facets")
+                share_facets_ = value == "true";
+            else
+                messages_.set_option(name, value);
         }
         void clear_options() override
         {
             invalid_ = true;
             use_ansi_encoding_ = false;
+            share_facets_ = false;
             locale_id_.clear();
-            paths_.clear();
-            domains_.clear();
+            messages_.clear();
         }
 
         void prepare_data()
@@ -64,7 +66,26 @@ namespace boost { namespace locale { namespace impl_icu {
         std::locale install(const std::locale& base, category_t category, char_facet_t type) override
         {
             prepare_data();
+            if(!share_facets_)
+                return install_facets(base, category, type);
+
+            const auto create_facets = [&](const std::locale& in) { return install_facets(in, category, type); };
+            const std::string key = "icu\n" + real_id_;
+            std::locale result = detail::install_shared_facets(base, key, category, type, create_facets);
+            // Formatting and parsing use the same cache and add it only if there is none yet
+            if((category == category_t::formatting || category == category_t::parsing)
+               && !std::has_facet<formatters_cache>(result))
+            {
+                const std::locale facets = detail::get_shared_facets(key, category, type, create_facets);
+                if(std::has_facet<formatters_cache>(facets))
+                    result = result.combine<formatters_cache>(facets);
+            }
+            return result;
+        }
 
+    private:
+        std::locale install_facets(const std::locale& base, category_t category, char_facet_t type)
+        {
             switch(category) {
                 case category_t::convert: return create_convert(base, data_, type);
                 case category_t::collation: return create_collate(base, data_, type);
@@ -72,7 +93,7 @@ namespace boost { namespace locale { namespace impl_icu {
                 case category_t::parsing: return create_parsing(base, data_, type);
                 case category_t::codepage: return create_codecvt(base, data_.encoding(), type);
                 case category_t::message:
-                    return detail::install_message_facet(base, type, data_.data(), domains_, paths_);
+                    return detail::install_message_facet(base, type, data_.data(), messages_);
                 case category_t::boundary: return create_boundary(base, data_, type);
                 case category_t::calendar: return create_calendar(base, data_);
                 case category_t::information: return util::create_info(base, real_id_);
@@ -80,14 +101,13 @@ namespace boost { namespace locale { namespace impl_icu {
             return base;
         }
 
-    private:
-        std::vector<std::string> paths_;
-        std::vector<std::string> domains_;
+        detail::message_options messages_;
         std::string locale_id_;
         std::string real_id_;
         cdata data_;
         bool invalid_;
         bool use_ansi_encoding_;
+        bool share_facets_;
     };
 
     std::unique_ptr<localization_backend> create_localization_backend()
@@ -19,6 +19,7 @@
 #    include <xlocale.h>
 #endif
 
+#include "../shared/facet_table.hpp"
 #include "../shared/message.hpp"
 #include "../util/gregorian.hpp"
 #include "../util/make_std_unique.hpp"
@@ -28,10 +29,10 @@ namespace boost { namespace locale { namespace impl_posix {
 
     class posix_localization_backend : public localization_backend {
     public:
-        posix_localization_backend() : invalid_(true) {}
+        posix_localization_backend() : invalid_(true), share_facets_(false) {}
         posix_localization_backend(const posix_localization_backend& other) :
-            localization_backend(), paths_(other.paths_), domains_(other.domains_), locale_id_(other.locale_id_),
-            invalid_(true)
+            localization_backend(), messages_(other.messages_), locale_id_(other.locale_id_),
+            invalid_(true), share_facets_(other.share_facets_)
         {}
         posix_localization_backend* clone() const override { return new posix_localization_backend(*this); }
 
@@ -40,17 +41,17 @@ namespace boost { namespace locale { namespace impl_posix {
             invalid_ = true;
             if(name == "locale")
                 locale_id_ = value;
-            else if(name == "message_path")
-                paths_.push_back(value);
-            else if(name == "message_application")
-                domains_.push_back(value);
+            else if(name == "share_facets")
+                share_facets_ = value == "true";
+            else
+                messages_.set_option(name, value);
         }
         void clear_options() override
         {
             invalid_ = true;
+            share_facets_ = false;
             locale_id_.clear();
-            paths_.clear();
-            domains_.clear();
+            messages_.clear();
         }
 
         static void free_locale_by_ptr(locale_t* lc)
@@ -88,7 +89,15 @@ namespace boost { namespace locale { namespace impl_posix {
         std::locale install(const std::locale& base, category_t category, char_facet_t type) override
         {
             prepare_data();
+            if(!share_facets_)
+                return install_facets(base, category, type);
+            const auto create_facets = [&](const std::locale& in) { return install_facets(in, category, type); };
+            return detail::install_shared_facets(base, "posix\n" + real_id_, category, type, create_facets);
+        }
 
+    private:
+        std::locale install_facets(const std::locale& base, category_t category, char_facet_t type)
+        {
             switch(category) {
                 case category_t::convert: return create_convert(base, lc_, type);
                 case category_t::collation: return create_collate(base, lc_, type);
@@ -96,22 +105,21 @@ namespace boost { namespace locale { namespace impl_posix {
                 case category_t::parsing: return create_parsing(base, lc_, type);
                 case category_t::codepage: return create_codecvt(base, nl_langinfo_l(CODESET, *lc_), type);
                 case category_t::calendar: return util::install_gregorian_calendar(base, data_.country());
-                case category_t::message: return detail::install_message_facet(base, type, data_, domains_, paths_);
+                case category_t::message: return detail::install_message_facet(base, type, data_, messages_);
                 case category_t::information: return util::create_info(base, real_id_);
                 case category_t::boundary: break; // Not implemented
             }
             return base;
         }
 
-    private:
-        std::vector<std::string> paths_;
-        std::vector<std::string> domains_;
+        detail::message_options messages_;
         std::string locale_id_;
         std::string real_id_;
         util::locale_data data_;
 
         bool invalid_;
         std::shared_ptr<locale_t> lc_;
+        bool share_facets_;
     };
 
     std::unique_ptr<localization_backend> create_localization_backend()
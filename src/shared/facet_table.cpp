@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2024 Alexander Grund
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#include "facet_table.hpp"
+#include "locale_cache.hpp"
+#include <boost/locale/boundary/facets.hpp>
+#include <boost/locale/collator.hpp>
+#include <boost/locale/conversion.hpp>
+#include <boost/locale/date_time_facet.hpp>
+#include <boost/locale/info.hpp>
+#include <boost/locale/localization_backend.hpp>
+#include <boost/locale/message.hpp>
+
+namespace boost { namespace locale { namespace detail {
+    namespace {
+        /// Maximum number of facet sets in the facet table, each for a key, category and character type
+        constexpr size_t max_shared_facet_sets = 1024;
+
+        /// Process-wide table of the facets installed for a key, category and character type.
+        ///
+        /// Facets are created only once also for concurrent requests. The least recently used ones are removed
+        /// when there are too many as keys of locales no longer generated would be kept forever otherwise.
+        /// Removed facets are still used by the locales they were installed into.
+        locale_cache& facet_table()
+        {
+            static locale_cache table(max_shared_facet_sets);
+            return table;
+        }
+
+        template<typename Facet>
+        void copy_facet(std::locale& to, const std::locale& from)
+        {
+            if(!std::has_facet<Facet>(from))
+                return;
+            const std::locale& classic = std::locale::classic();
+            if(std::has_facet<Facet>(classic) && &std::use_facet<Facet>(from) == &std::use_facet<Facet>(classic))
+                return;
+            to = to.combine<Facet>(from);
+        }
+
+        template<typename CharType>
+        void copy_char_facets(std::locale& to, const std::locale& from, const category_t category)
+        {
+            if(category == category_t::collation)
+                copy_facet<collator<CharType>>(to, from);
+            else if(category == category_t::boundary)
+                copy_facet<boundary::boundary_indexing<CharType>>(to, from);
+        }
+
+        // Facets using std::basic_string<CharType>
+        template<typename CharType>
+        void copy_string_facets(std::locale& to, const std::locale& from, const category_t category)
+        {
+            if(category == category_t::convert)
+                copy_facet<converter<CharType>>(to, from);
+            else if(category == category_t::message)
+                copy_facet<message_format<CharType>>(to, from);
+        }
+
+        template<typename CharType>
+        void copy_std_facets(std::locale& to, const std::locale& from, const category_t category)
+        {
+            if(category == category_t::collation)
+                copy_facet<std::collate<CharType>>(to, from);
+            else if(category == category_t::codepage)
+                copy_facet<std::codecvt<CharType, char, std::mbstate_t>>(to, from);
+            else if(category == category_t::formatting || category == category_t::parsing) {
+                copy_facet<std::numpunct<CharType>>(to, from);
+                copy_facet<std::moneypunct<CharType, true>>(to, from);
+                copy_facet<std::moneypunct<CharType, false>>(to, from);
+                copy_facet<std::ctype<CharType>>(to, from);
+                copy_facet<std::time_put<CharType>>(to, from);
+                copy_facet<std::num_put<CharType>>(to, from);
+                copy_facet<std::num_get<CharType>>(to, from);
+            }
+        }
+
+        template<typename CharType>
+        void copy_all_char_facets(std::locale& to, const std::locale& from, const category_t category)
+        {
+            copy_char_facets<CharType>(to, from, category);
+            copy_string_facets<CharType>(to, from, category);
+            copy_std_facets<CharType>(to, from, category);
+        }
+    } // namespace
+
+    void copy_facets(std::locale& to, const std::locale& from, const category_t category, const char_facet_t chars)
+    {
+        if(category == category_t::calendar)
+            copy_facet<calendar_facet>(to, from);
+        else if(category == category_t::information)
+            copy_facet<info>(to, from);
+        for(char_facet_t ch = character_facet_first; ch <= character_facet_last; ++ch) {
+            if(!(ch & chars))
+                continue;
+            switch(ch) {
+                case char_facet_t::nochar: break;
+                case char_facet_t::char_f: copy_all_char_facets<char>(to, from, category); break;
+                case char_facet_t::wchar_f: copy_all_char_facets<wchar_t>(to, from, category); break;
+#ifdef __cpp_char8_t
+                case char_facet_t::char8_f:
+                    copy_char_facets<char8_t>(to, from, category);
+#    ifdef __cpp_lib_char8_t
+                    copy_string_facets<char8_t>(to, from, category);
+#    endif
+                    break; // std-facets not available (yet)
+#endif
+#ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+                case char_facet_t::char16_f: copy_all_char_facets<char16_t>(to, from, category); break;
+#endif
+#ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+                case char_facet_t::char32_f: copy_all_char_facets<char32_t>(to, from, category); break;
+#endif
+            }
+        }
+    }
+
+    std::locale get_shared_facets(const std::string& key,
+                                  const category_t category,
+                                  const char_facet_t type,
+                                  const std::function<std::locale(const std::locale&)>& install)
+    {
+        const std::string full_key = key + '\n' + std::to_string(static_cast<uint32_t>(category)) + '\n'
+                                     + std::to_string(static_cast<uint32_t>(type));
+        return facet_table().get(full_key, [&]() { return install(std::locale::classic()); });
+    }
+
+    std::locale install_shared_facets(const std::locale& base,
+                                      const std::string& key,
+                                      const category_t category,
+                                      const char_facet_t type,
+                                      const std::function<std::locale(const std::locale&)>& install)
+    {
+        if(!(shareable_categories & category))
+            return install(base);
+        std::locale result = base;
+        copy_facets(result, get_shared_facets(key, category, type, install), category, type);
+        return result;
+    }
+}}} // namespace boost::locale::detail
+
+namespace boost { namespace locale {
+    void clear_shared_facets()
+    {
+        detail::facet_table().clear();
+    }
+}} // namespace boost::locale
@@ -0,0 +1,43 @@
+//
+// Copyright (c) 2024 Alexander Grund
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_LOCALE_SHARED_FACET_TABLE_HPP
+#define BOOST_LOCALE_SHARED_FACET_TABLE_HPP
+
+#include <boost/locale/generator.hpp>
+#include <functional>
+#include <locale>
+#include <string>
+
+namespace boost { namespace locale { namespace detail {
+    /// Categories whose facets only depend on the locale and not on other options such as message domains
+    constexpr category_t shareable_categories = all_categories ^ category_t::message;
+
+    /// Copy the facets of \a category for \a chars from \a from to \a to.
+    ///
+    /// Only facets defined by this library and the standard facets used by the backends are known.
+    /// Facets which are those of the classic locale are skipped as they were not installed by a backend.
+    void copy_facets(std::locale& to, const std::locale& from, category_t category, char_facet_t chars);
+
+    /// Get the facets of \a category for \a type installed into the classic locale by \a install.
+    ///
+    /// The facets are created only once per \a key, which must identify everything they depend on,
+    /// and are shared by all locales they get installed into afterwards.
+    std::locale get_shared_facets(const std::string& key,
+                                  category_t category,
+                                  char_facet_t type,
+                                  const std::function<std::locale(const std::locale&)>& install);
+
+    /// Install the facets of \a category for \a type into \a base sharing them with all locales using the same \a key
+    /// if the \a category is shareable or installing new ones using \a install otherwise
+    std::locale install_shared_facets(const std::locale& base,
+                                      const std::string& key,
+                                      category_t category,
+                                      char_facet_t type,
+                                      const std::function<std::locale(const std::locale&)>& install);
+}}} // namespace boost::locale::detail
+
+#endif
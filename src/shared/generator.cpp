@@ -8,27 +8,163 @@
 #include <boost/locale/encoding.hpp>
 #include <boost/locale/generator.hpp>
 #include <boost/locale/localization_backend.hpp>
+#include <boost/locale/util/locale_data.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include "../util/encoding.hpp"
+#include "facet_table.hpp"
+#include "instrumentation.hpp"
+#include "locale_cache.hpp"
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
 #include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace boost { namespace locale {
+    namespace {
+        /// Table of the canonical spelling of locale ids, so all spellings of a locale share the same cache entry.
+        ///
+        /// The canonical ids of the first used spellings are kept to avoid parsing them again on each lookup.
+        class locale_id_table {
+        public:
+            std::string canonical(const std::string& id)
+            {
+                {
+                    boost::shared_lock<boost::shared_mutex> guard(lock_);
+                    const auto p = ids_.find(id);
+                    if(p != ids_.end())
+                        return p->second;
+                }
+                std::string result = canonicalize(id);
+                boost::unique_lock<boost::shared_mutex> guard(lock_);
+                if(ids_.size() < max_ids)
+                    ids_.emplace(id, result);
+                return result;
+            }
+
+        private:
+            /// Bound for ids taken from untrusted input, e.g. HTTP headers
+            static constexpr size_t max_ids = 256;
+
+            static std::string canonicalize(const std::string& id)
+            {
+                util::locale_data data;
+                if(!data.parse(id))
+                    return id;
+                // Omitted by to_string but not equivalent to no encoding for all backends
+                if(id.find('.') != std::string::npos && util::are_encodings_equal(data.encoding(), "US-ASCII"))
+                    return id;
+                if(data.is_utf8())
+                    data.encoding("UTF-8");
+                return data.to_string();
+            }
+
+            boost::shared_mutex lock_;
+            std::unordered_map<std::string, std::string> ids_;
+        };
+
+        /// Backends with all options of a generator set, which are reused for generating locales.
+        ///
+        /// Creating a backend clones all registered backends and sets all options again, which is avoided by
+        /// taking an unused one from here and only changing its locale. Clearing the pool after changing options
+        /// also discards the backends in use at that time when they get released.
+        class backend_pool {
+        public:
+            backend_pool() : version_(0) {}
+
+            struct lease {
+                std::unique_ptr<localization_backend> backend;
+                uint64_t version;
+            };
+
+            /// Take an unused backend from the pool, the backend of the result is null if there is none
+            lease acquire()
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                lease result{nullptr, version_};
+                if(!backends_.empty()) {
+                    result.backend = std::move(backends_.back());
+                    backends_.pop_back();
+                }
+                return result;
+            }
+
+            /// Return a backend to the pool
+            void release(lease used)
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                if(used.version == version_ && backends_.size() < max_backends)
+                    backends_.push_back(std::move(used.backend));
+            }
+
+            void clear()
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                backends_.clear();
+                ++version_;
+            }
+
+        private:
+            /// More than the number of categories installed concurrently for a single locale
+            static constexpr size_t max_backends = 16;
+
+            boost::mutex lock_;
+            std::vector<std::unique_ptr<localization_backend>> backends_;
+            uint64_t version_;
+        };
+
+        std::locale install_categories(localization_backend& backend,
+                                       std::locale result,
+                                       const std::string& id,
+                                       const category_t facets,
+                                       const char_facet_t chars,
+                                       const detail::instrumentation& events)
+        {
+            for(category_t facet = per_character_facet_first; facet <= per_character_facet_last; ++facet) {
+                if(!(facets & facet))
+                    continue;
+                for(char_facet_t ch = character_facet_first; ch <= character_facet_last; ++ch) {
+                    if(ch & chars)
+                        result = events.install(backend, result, id, facet, ch);
+                }
+            }
+            for(category_t facet = non_character_facet_first; facet <= non_character_facet_last; ++facet) {
+                if(facets & facet)
+                    result = events.install(backend, result, id, facet, char_facet_t::nochar);
+            }
+            return result;
+        }
+    } // namespace
+
     struct generator::data {
         data(const localization_backend_manager& mgr) :
             cats(all_categories), chars(all_characters), caching_enabled(false), use_ansi_encoding(false),
-            backend_manager(mgr)
+            use_memory_mapping(false), cache_literal_lookups(false), lazy_catalog_loading(false),
+            cache_catalog_directories(false), share_facets(false), backend_manager(mgr)
         {}
 
-        mutable std::map<std::string, std::locale> cached;
-        mutable boost::mutex cached_lock;
+        mutable detail::locale_cache cached;
+        mutable locale_id_table ids;
+        mutable backend_pool backends;
+        std::shared_ptr<generation_observer> observer;
 
         category_t cats;
         char_facet_t chars;
 
         bool caching_enabled;
         bool use_ansi_encoding;
+        bool use_memory_mapping;
+        bool cache_literal_lookups;
+        bool lazy_catalog_loading;
+        bool cache_catalog_directories;
+        bool share_facets;
 
         std::vector<std::string> paths;
         std::vector<std::string> domains;
@@ -63,8 +199,10 @@ namespace boost { namespace locale {
 
     void generator::add_messages_domain(const std::string& domain)
     {
-        if(std::find(d->domains.begin(), d->domains.end(), domain) == d->domains.end())
+        if(std::find(d->domains.begin(), d->domains.end(), domain) == d->domains.end()) {
             d->domains.push_back(domain);
+            d->backends.clear();
+        }
     }
 
     void generator::set_default_messages_domain(const std::string& domain)
@@ -73,19 +211,23 @@ namespace boost { namespace locale {
         if(p != d->domains.end())
             d->domains.erase(p);
         d->domains.insert(d->domains.begin(), domain);
+        d->backends.clear();
     }
 
     void generator::clear_domains()
     {
         d->domains.clear();
+        d->backends.clear();
     }
     void generator::add_messages_path(const std::string& path)
     {
         d->paths.push_back(path);
+        d->backends.clear();
     }
     void generator::clear_paths()
     {
         d->paths.clear();
+        d->backends.clear();
     }
     void generator::clear_cache()
     {
@@ -99,37 +241,59 @@ namespace boost { namespace locale {
 
     std::locale generator::generate(const std::locale& base, const std::string& id) const
     {
-        if(d->caching_enabled) {
-            boost::unique_lock<boost::mutex> guard(d->cached_lock);
-            const auto p = d->cached.find(id);
-            if(p != d->cached.end())
-                return p->second;
+        if(d->caching_enabled)
+            return cached_locale(base, id);
+        return create_locale(base, id);
+    }
+
+    std::locale generator::cached_locale(const std::locale& base, const std::string& id) const
+    {
+        const std::string canonical_id = d->ids.canonical(id);
+        bool created = false;
+        std::locale result = d->cached.get(canonical_id, [&]() {
+            created = true;
+            detail::instrumentation(d->observer).cache_miss(canonical_id);
+            return create_locale(base, canonical_id);
+        });
+        if(!created)
+            detail::instrumentation(d->observer).cache_hit(canonical_id);
+        return result;
+    }
+
+    void generator::prewarm(const std::vector<std::string>& ids,
+                            const executor_type& executor,
+                            const prewarm_callback_type& callback) const
+    {
+        for(const std::string& id : ids) {
+            executor([this, id, callback]() {
+                std::exception_ptr error;
+                try {
+                    cached_locale(std::locale::classic(), id);
+                } catch(...) {
+                    error = std::current_exception();
+                }
+                if(callback)
+                    callback(id, error);
+            });
         }
-        auto backend = d->backend_manager.create();
-        set_all_options(*backend, id);
+    }
 
-        std::locale result = base;
+    std::locale generator::create_locale(const std::locale& base, const std::string& id) const
+    {
         const category_t facets = d->cats;
         const char_facet_t chars = d->chars;
 
-        for(category_t facet = per_character_facet_first; facet <= per_character_facet_last; ++facet) {
-            if(!(facets & facet))
-                continue;
-            for(char_facet_t ch = character_facet_first; ch <= character_facet_last; ++ch) {
-                if(ch & chars)
-                    result = backend->install(result, facet, ch);
-            }
-        }
-        for(category_t facet = non_character_facet_first; facet <= non_character_facet_last; ++facet) {
-            if(facets & facet)
-                result = backend->install(result, facet, char_facet_t::nochar);
-        }
-        if(d->caching_enabled) {
-            boost::unique_lock<boost::mutex> guard(d->cached_lock);
-            const auto p = d->cached.find(id);
-            if(p == d->cached.end())
-                d->cached[id] = result;
+        // Use a prepared backend if possible and return it afterwards
+        const detail::instrumentation events(d->observer);
+        backend_pool::lease lease = d->backends.acquire();
+        if(lease.backend)
+            lease.backend->set_option("locale", id);
+        else {
+            lease.backend = d->backend_manager.create();
+            set_all_options(*lease.backend, id);
         }
+        std::locale result = install_categories(*lease.backend, base, id, facets, chars, events);
+        d->backends.release(std::move(lease));
         return result;
     }
 
@@ -141,6 +305,62 @@ namespace boost { namespace locale {
     void generator::use_ansi_encoding(bool v)
     {
         d->use_ansi_encoding = v;
+        d->backends.clear();
+    }
+
+    bool generator::use_memory_mapped_catalogs() const
+    {
+        return d->use_memory_mapping;
+    }
+
+    void generator::use_memory_mapped_catalogs(bool on)
+    {
+        d->use_memory_mapping = on;
+        d->backends.clear();
+    }
+
+    bool generator::cache_literal_lookups() const
+    {
+        return d->cache_literal_lookups;
+    }
+
+    void generator::cache_literal_lookups(bool on)
+    {
+        d->cache_literal_lookups = on;
+        d->backends.clear();
+    }
+
+    bool generator::lazy_catalog_loading() const
+    {
+        return d->lazy_catalog_loading;
+    }
+
+    void generator::lazy_catalog_loading(bool on)
+    {
+        d->lazy_catalog_loading = on;
+        d->backends.clear();
+    }
+
+    bool generator::cache_catalog_directories() const
+    {
+        return d->cache_catalog_directories;
+    }
+
+    void generator::cache_catalog_directories(bool on)
+    {
+        d->cache_catalog_directories = on;
+        d->backends.clear();
+    }
+
+    bool generator::share_facets() const
+    {
+        return d->share_facets;
+    }
+
+    void generator::share_facets(bool on)
+    {
+        d->share_facets = on;
+        d->backends.clear();
     }
 
     bool generator::locale_cache_enabled() const
@@ -152,6 +372,38 @@ namespace boost { namespace locale {
         d->caching_enabled = enabled;
     }
 
+    size_t generator::locale_cache_limit() const
+    {
+        return d->cached.limit();
+    }
+    void generator::locale_cache_limit(size_t max_locales)
+    {
+        d->cached.limit(max_locales);
+    }
+
+    locale_cache_statistics generator::locale_cache_stats() const
+    {
+        return d->cached.statistics();
+    }
+
+    void generator::observer(std::shared_ptr<generation_observer> observer)
+    {
+        d->observer = std::move(observer);
+    }
+
+    std::shared_ptr<generation_observer> generator::observer() const
+    {
+        return d->observer;
+    }
+
+    generation_observer::~generation_observer() = default;
+    void generation_observer::cache_hit(const std::string&) {}
+    void generation_observer::cache_miss(const std::string&) {}
+    void generation_observer::category_installed(const std::string&, category_t, char_facet_t, std::chrono::nanoseconds)
+    {}
+    void generation_observer::catalog_loaded(const std::string&, size_t) {}
+    void generation_observer::icu_object_created(const char*) {}
+
     void generator::set_all_options(localization_backend& backend, const std::string& id) const
     {
         backend.set_option("locale", id);
@@ -160,6 +412,11 @@ namespace boost { namespace locale {
             backend.set_option("message_application", domain);
         for(const std::string& path : d->paths)
             backend.set_option("message_path", path);
+        backend.set_option("message_memory_mapping", d->use_memory_mapping ? "true" : "false");
+        backend.set_option("message_cache_literal_lookups", d->cache_literal_lookups ? "true" : "false");
+        backend.set_option("message_lazy_loading", d->lazy_catalog_loading ? "true" : "false");
+        backend.set_option("message_cache_directories", d->cache_catalog_directories ? "true" : "false");
+        backend.set_option("share_facets", d->share_facets ? "true" : "false");
     }
 
     // Sanity check
@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2025 Alexander Grund
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_LOCALE_SHARED_INSTRUMENTATION_HPP
+#define BOOST_LOCALE_SHARED_INSTRUMENTATION_HPP
+
+#include <boost/locale/generator.hpp>
+#include <boost/locale/localization_backend.hpp>
+#include <locale>
+#include <memory>
+#include <string>
+#ifdef BOOST_LOCALE_ENABLE_INSTRUMENTATION
+#    include <chrono>
+#    include <utility>
+#endif
+
+namespace boost { namespace locale { namespace detail {
+#ifdef BOOST_LOCALE_ENABLE_INSTRUMENTATION
+    /// The global observer of localization_backend_manager without taking its lock unless it was replaced
+    std::shared_ptr<generation_observer> current_global_observer();
+
+    /// Reports events to the given generation_observer or the global one if there is none
+    class instrumentation {
+    public:
+        explicit instrumentation(std::shared_ptr<generation_observer> observer = nullptr) :
+            observer_(std::move(observer))
+        {}
+
+        void cache_hit(const std::string& id) const
+        {
+            if(const auto observer = get_observer())
+                observer->cache_hit(id);
+        }
+        void cache_miss(const std::string& id) const
+        {
+            if(const auto observer = get_observer())
+                observer->cache_miss(id);
+        }
+        void catalog_loaded(const std::string& file_name, size_t size) const
+        {
+            if(const auto observer = get_observer())
+                observer->catalog_loaded(file_name, size);
+        }
+        void icu_object_created(const char* kind) const
+        {
+            if(const auto observer = get_observer())
+                observer->icu_object_created(kind);
+        }
+
+        /// Install the facets of \a category for \a type into \a in using \a backend and report the duration
+        std::locale install(localization_backend& backend,
+                            const std::locale& in,
+                            const std::string& id,
+                            category_t category,
+                            char_facet_t type) const
+        {
+            const auto observer = get_observer();
+            if(!observer)
+                return backend.install(in, category, type);
+            const auto start = std::chrono::steady_clock::now();
+            std::locale result = backend.install(in, category, type);
+            observer->category_installed(id, category, type, std::chrono::steady_clock::now() - start);
+            return result;
+        }
+
+    private:
+        /// The observer to report to, the global one is only read when an event is delivered
+        std::shared_ptr<generation_observer> get_observer() const
+        {
+            return observer_ ? observer_ : current_global_observer();
+        }
+
+        std::shared_ptr<generation_observer> observer_;
+    };
+#else
+    /// Disabled instrumentation, all calls compile to nothing
+    class instrumentation {
+    public:
+        explicit instrumentation(const std::shared_ptr<generation_observer>& = nullptr) {}
+
+        void cache_hit(const std::string&) const {}
+        void cache_miss(const std::string&) const {}
+        void catalog_loaded(const std::string&, size_t) const {}
+        void icu_object_created(const char*) const {}
+
+        std::locale install(localization_backend& backend,
+                            const std::locale& in,
+                            const std::string&,
+                            category_t category,
+                            char_facet_t type) const
+        {
+            return backend.install(in, category, type);
+        }
+    };
+#endif
+}}} // namespace boost::locale::detail
+
+#endif
@@ -0,0 +1,231 @@
+//
+// Copyright (c) 2024 Alexander Grund
+//
+// Distributed under the Boost Software License, Version 1.0.
+// https://www.boost.org/LICENSE_1_0.txt
+
+#ifndef BOOST_LOCALE_SHARED_LOCALE_CACHE_HPP
+#define BOOST_LOCALE_SHARED_LOCALE_CACHE_HPP
+
+#include <boost/locale/generator.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+namespace boost { namespace locale { namespace detail {
+    /// Cache of generated locales by id.
+    ///
+    /// The entries are split into shards by the hash of the id with a reader-writer lock each,
+    /// so lookups don't block each other and only contend with insertions into the same shard.
+    /// A missing locale is created only once, concurrent requests for it wait for that result.
+    /// If the number of entries is limited the least recently used ones are removed.
+    class locale_cache {
+    public:
+        explicit locale_cache(size_t max_locales = 0) :
+            limit_(max_locales), size_(0), clock_(0), hits_(0), misses_(0), evictions_(0), generation_ns_(0)
+        {}
+
+        /// Return the cached locale for \a id or create and cache it using \a create
+        template<typename Creator>
+        std::locale get(const std::string& id, Creator create)
+        {
+            shard& s = get_shard(id);
+            {
+                boost::shared_lock<boost::shared_mutex> guard(s.lock);
+                const auto p = s.locales.find(id);
+                if(p != s.locales.end())
+                    return use(p->second);
+            }
+            std::shared_ptr<pending_locale> pending;
+            {
+                boost::unique_lock<boost::shared_mutex> guard(s.lock);
+                const auto p = s.locales.find(id);
+                if(p != s.locales.end())
+                    return use(p->second);
+                auto& in_flight = s.pending[id];
+                if(in_flight)
+                    pending = in_flight;
+                else
+                    in_flight = std::make_shared<pending_locale>();
+            }
+            if(pending) {
+                ++hits_;
+                return pending->wait();
+            }
+            return create_locale(s, id, create);
+        }
+
+        void clear()
+        {
+            for(shard& s : shards_) {
+                boost::unique_lock<boost::shared_mutex> guard(s.lock);
+                size_ -= s.locales.size();
+                s.locales.clear();
+            }
+        }
+
+        size_t limit() const { return limit_; }
+        void limit(size_t max_locales)
+        {
+            limit_ = max_locales;
+            shrink();
+        }
+
+        locale_cache_statistics statistics() const
+        {
+            locale_cache_statistics result;
+            result.hits = hits_;
+            result.misses = misses_;
+            result.evictions = evictions_;
+            result.generation_time = std::chrono::nanoseconds(generation_ns_.load());
+            return result;
+        }
+
+    private:
+        static constexpr size_t num_shards = 16;
+
+        /// Result of a locale creation in progress
+        class pending_locale {
+        public:
+            pending_locale() : done_(false) {}
+
+            std::locale wait()
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                while(!done_)
+                    cond_.wait(guard);
+                if(error_)
+                    std::rethrow_exception(error_);
+                return result_;
+            }
+            void set(const std::locale& result, std::exception_ptr error)
+            {
+                {
+                    boost::unique_lock<boost::mutex> guard(lock_);
+                    result_ = result;
+                    error_ = error;
+                    done_ = true;
+                }
+                cond_.notify_all();
+            }
+
+        private:
+            boost::mutex lock_;
+            boost::condition_variable cond_;
+            bool done_;
+            std::locale result_;
+            std::exception_ptr error_;
+        };
+
+        struct entry {
+            entry(const std::locale& l, uint64_t time) : loc(l), last_used(time) {}
+            std::locale loc;
+            std::atomic<uint64_t> last_used; ///< Time of the last use, only updated when the size is limited
+        };
+
+        struct shard {
+            mutable boost::shared_mutex lock;
+            std::unordered_map<std::string, entry> locales;
+            std::unordered_map<std::string, std::shared_ptr<pending_locale>> pending;
+        };
+
+        const std::locale& use(entry& e)
+        {
+            ++hits_;
+            if(limit_.load(std::memory_order_relaxed) != 0)
+                e.last_used.store(++clock_, std::memory_order_relaxed);
+            return e.loc;
+        }
+
+        template<typename Creator>
+        std::locale create_locale(shard& s, const std::string& id, Creator& create)
+        {
+            ++misses_;
+            std::locale result;
+            std::exception_ptr error;
+            const auto start = std::chrono::steady_clock::now();
+            try {
+                result = create();
+            } catch(...) {
+                error = std::current_exception();
+            }
+            generation_ns_ += static_cast<uint64_t>(
+              std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                .count());
+            std::shared_ptr<pending_locale> pending;
+            {
+                boost::unique_lock<boost::shared_mutex> guard(s.lock);
+                if(!error) {
+                    s.locales.emplace(std::piecewise_construct,
+                                      std::forward_as_tuple(id),
+                                      std::forward_as_tuple(result, ++clock_));
+                    ++size_;
+                }
+                const auto p = s.pending.find(id);
+                pending = std::move(p->second);
+                s.pending.erase(p);
+            }
+            pending->set(result, error);
+            if(error)
+                std::rethrow_exception(error);
+            shrink();
+            return result;
+        }
+
+        /// Remove the least recently used entries until the limit is met
+        void shrink()
+        {
+            boost::unique_lock<boost::mutex> guard(shrink_lock_);
+            const size_t max_size = limit_;
+            while(max_size != 0 && size_ > max_size) {
+                shard* oldest_shard = nullptr;
+                std::string oldest_id;
+                uint64_t oldest_time = std::numeric_limits<uint64_t>::max();
+                for(shard& s : shards_) {
+                    boost::shared_lock<boost::shared_mutex> shard_guard(s.lock);
+                    for(const auto& p : s.locales) {
+                        const uint64_t time = p.second.last_used.load(std::memory_order_relaxed);
+                        if(time < oldest_time) {
+                            oldest_time = time;
+                            oldest_id = p.first;
+                            oldest_shard = &s;
+                        }
+                    }
+                }
+                if(!oldest_shard)
+                    break; // LCOV_EXCL_LINE
+                boost::unique_lock<boost::shared_mutex> shard_guard(oldest_shard->lock);
+                if(oldest_shard->locales.erase(oldest_id) != 0) {
+                    --size_;
+                    ++evictions_;
+                }
+            }
+        }
+
+        shard& get_shard(const std::string& id) { return shards_[std::hash<std::string>()(id) % num_shards]; }
+
+        shard shards_[num_shards];
+        boost::mutex shrink_lock_;
+        std::atomic<size_t> limit_;
+        std::atomic<size_t> size_;
+        std::atomic<uint64_t> clock_;
+        std::atomic<uint64_t> hits_;
+        std::atomic<uint64_t> misses_;
+        std::atomic<uint64_t> evictions_;
+        std::atomic<uint64_t> generation_ns_;
+    };
+}}} // namespace boost::locale::detail
+
+#endif
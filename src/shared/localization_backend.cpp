@@ -7,6 +7,10 @@
 #include <boost/locale/localization_backend.hpp>
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include "instrumentation.hpp"
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -221,6 +225,13 @@ namespace boost { namespace locale {
             static localization_backend_manager the_manager = make_default_backend_mgr();
             return the_manager;
         }
+        std::shared_ptr<generation_observer>& global_generation_observer()
+        {
+            static std::shared_ptr<generation_observer> the_observer;
+            return the_observer;
+        }
+        /// Incremented on each change of the global observer, 0 if it was never set
+        std::atomic<uint64_t> global_generation_observer_version(0);
     } // namespace
 
     localization_backend_manager localization_backend_manager::global()
@@ -234,4 +245,47 @@ namespace boost { namespace locale {
         return exchange(localization_backend_manager_global(), in);
     }
 
+    std::shared_ptr<generation_observer>
+    localization_backend_manager::global_observer(std::shared_ptr<generation_observer> observer)
+    {
+        boost::unique_lock<boost::mutex> lock(localization_backend_manager_mutex());
+        std::shared_ptr<generation_observer> old_observer =
+          boost::exchange(global_generation_observer(), std::move(observer));
+        global_generation_observer_version.fetch_add(1, std::memory_order_release);
+        return old_observer;
+    }
+    std::shared_ptr<generation_observer> localization_backend_manager::global_observer()
+    {
+        boost::unique_lock<boost::mutex> lock(localization_backend_manager_mutex());
+        return global_generation_observer();
+    }
+
+#ifdef BOOST_LOCALE_ENABLE_INSTRUMENTATION
+    namespace detail {
+        std::shared_ptr<generation_observer> current_global_observer()
+        {
+            const uint64_t version = global_generation_observer_version.load(std::memory_order_acquire);
+            if(version == 0)
+                return nullptr;
+            // Each thread keeps a copy of the observer and only takes the lock when it was replaced
+            struct snapshot {
+                uint64_t version = 0;
+                std::shared_ptr<generation_observer> observer;
+            };
+            static boost::thread_specific_ptr<snapshot> snapshots;
+            snapshot* current = snapshots.get();
+            if(!current) {
+                current = new snapshot();
+                snapshots.reset(current);
+            }
+            if(current->version != version) {
+                boost::unique_lock<boost::mutex> lock(localization_backend_manager_mutex());
+                current->observer = global_generation_observer();
+                current->version = global_generation_observer_version.load(std::memory_order_relaxed);
+            }
+            return current->observer;
+        }
+    } // namespace detail
+#endif
+
 }} // namespace boost::locale
@@ -19,21 +19,44 @@
 #include <boost/locale/gnu_gettext.hpp>
 
 #include <boost/locale/encoding.hpp>
+#include <boost/locale/encoding_utf.hpp>
 #include <boost/locale/message.hpp>
+#include <boost/locale/util/string.hpp>
 #include "../util/encoding.hpp"
 #include "../util/foreach_char.hpp"
+#include "instrumentation.hpp"
 #include "message.hpp"
 #include "mo_hash.hpp"
 #include "mo_lambda.hpp"
 #include <boost/assert.hpp>
 #include <boost/core/detail/string_view.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
+#include <cstring>
+#include <exception>
+#include <limits>
 #include <map>
 #include <memory>
+#include <set>
 #include <stdexcept>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#if defined(BOOST_WINDOWS)
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <io.h>
+#    include <windows.h>
+#else
+#    include <dirent.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#endif
+
 namespace boost { namespace locale { namespace gnu_gettext {
 
     std::vector<std::string> messages_info::get_lang_folders() const
@@ -117,9 +140,197 @@ namespace boost { namespace locale { namespace gnu_gettext {
         }
     }
 
+    /// Map the whole file read-only into memory.
+    /// Returns an empty buffer if that isn't possible, e.g. for empty files or if the file system doesn't support it.
+    catalog_buffer map_file(FILE* file)
+    {
+#if defined(BOOST_WINDOWS)
+        const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+        LARGE_INTEGER file_size;
+        if(handle == INVALID_HANDLE_VALUE || !GetFileSizeEx(handle, &file_size) || file_size.QuadPart <= 0
+           || static_cast<unsigned long long>(file_size.QuadPart) > std::numeric_limits<size_t>::max())
+            return {};
+        const HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!mapping)
+            return {}; // LCOV_EXCL_LINE
+        void* const addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping); // The view keeps the mapping alive
+        if(!addr)
+            return {}; // LCOV_EXCL_LINE
+        const size_t size = static_cast<size_t>(file_size.QuadPart);
+        std::shared_ptr<const void> storage(addr, [](void* p) { UnmapViewOfFile(p); });
+#else
+        const int fd = fileno(file);
+        struct stat st;
+        if(fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0
+           || static_cast<unsigned long long>(st.st_size) > std::numeric_limits<size_t>::max())
+            return {};
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* const addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if(addr == MAP_FAILED)
+            return {}; // LCOV_EXCL_LINE
+        std::shared_ptr<const void> storage(addr, [size](void* p) { munmap(p, size); });
+#endif
+        return catalog_buffer(static_cast<const char*>(addr), size, std::move(storage));
+    }
+
+    /// Modification time, size and identity of a file used to detect changes of catalogs
+    struct file_stamp {
+        int64_t mtime = -1; ///< In the finest resolution available, e.g. nanoseconds
+        int64_t size = -1;
+        uint64_t id = 0; ///< Inode number if available, changes when the file is replaced by renaming another one
+
+        bool operator==(const file_stamp& other) const
+        {
+            return mtime == other.mtime && size == other.size && id == other.id;
+        }
+    };
+
+    file_stamp get_file_stamp(FILE* file)
+    {
+        file_stamp result;
+#if defined(BOOST_WINDOWS)
+        const HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file)));
+        FILETIME write_time;
+        LARGE_INTEGER file_size;
+        if(handle != INVALID_HANDLE_VALUE && GetFileTime(handle, nullptr, nullptr, &write_time)
+           && GetFileSizeEx(handle, &file_size))
+        {
+            result.mtime = (static_cast<int64_t>(write_time.dwHighDateTime) << 32) | write_time.dwLowDateTime;
+            result.size = file_size.QuadPart;
+        }
+#else
+        const int fd = fileno(file);
+        struct stat st;
+        if(fd >= 0 && fstat(fd, &st) == 0) {
+#    if defined(__APPLE__)
+            result.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#    elif defined(st_mtime) // Defined as st_mtim.tv_sec when the time is available with nanoseconds
+            result.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#    else
+            result.mtime = static_cast<int64_t>(st.st_mtime);
+#    endif
+            result.size = static_cast<int64_t>(st.st_size);
+            result.id = static_cast<uint64_t>(st.st_ino);
+        }
+#endif
+        return result;
+    }
+
+    /// Content of a catalog provided by a callback used to detect changes
+    struct buffer_stamp {
+        const char* data = nullptr;
+        size_t size = 0;
+        uint64_t hash = 0; ///< FNV-1a hash of the content
+
+        explicit buffer_stamp(const catalog_buffer& buffer = catalog_buffer()) :
+            data(buffer.data()), size(buffer.size()), hash(0xcbf29ce484222325u)
+        {
+            for(size_t i = 0; i < size; i++)
+                hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3u;
+        }
+    };
+
+    /// Process-wide cache of the names of the files in catalog directories.
+    ///
+    /// Allows to skip catalog files which don't exist without trying to open them, which can be costly.
+    class catalog_directory_cache {
+    public:
+        static catalog_directory_cache& instance()
+        {
+            static catalog_directory_cache cache;
+            return cache;
+        }
+
+        /// Check if the directory \a path contains a file \a file_name, both in the file name \a encoding
+        bool contains(const std::string& path, const std::string& file_name, const std::string& encoding)
+        {
+#if defined(BOOST_WINDOWS)
+            const std::string name = fold_name(conv::to_utf<wchar_t>(file_name, encoding));
+#else
+            const std::string& name = file_name;
+#endif
+            auto key = std::make_pair(path, encoding);
+            {
+                boost::unique_lock<boost::mutex> guard(lock_);
+                const auto it = directories_.find(key);
+                if(it != directories_.end())
+                    return it->second.count(name) != 0;
+            }
+            // Don't block other lookups while accessing the file system
+            std::set<std::string> files = list_directory(path, encoding);
+            const bool result = files.count(name) != 0;
+            boost::unique_lock<boost::mutex> guard(lock_);
+            if(directories_.size() >= max_directories)
+                directories_.clear();
+            directories_.emplace(std::move(key), std::move(files));
+            return result;
+        }
+
+        void clear()
+        {
+            boost::unique_lock<boost::mutex> guard(lock_);
+            directories_.clear();
+        }
+
+    private:
+#if defined(BOOST_WINDOWS)
+        // File names are case insensitive, so compare them as (ASCII) lower case UTF-8
+        static std::string fold_name(const std::wstring& name)
+        {
+            std::string result = conv::utf_to_utf<char>(name);
+            for(char& c : result) {
+                if('A' <= c && c <= 'Z')
+                    c += 'a' - 'A';
+            }
+            return result;
+        }
+
+        static std::set<std::string> list_directory(const std::string& path, const std::string& encoding)
+        {
+            std::set<std::string> result;
+            const std::wstring pattern = conv::to_utf<wchar_t>(path, encoding) + L"\\*";
+            WIN32_FIND_DATAW entry;
+            const HANDLE handle = FindFirstFileW(pattern.c_str(), &entry);
+            if(handle != INVALID_HANDLE_VALUE) {
+                do {
+                    result.insert(fold_name(entry.cFileName));
+                } while(FindNextFileW(handle, &entry));
+                FindClose(handle);
+            }
+            return result;
+        }
+#else
+        // We do not use encoding as we use native file name encoding
+        static std::set<std::string> list_directory(const std::string& path, const std::string& /* encoding */)
+        {
+            std::set<std::string> result;
+            DIR* const dir = opendir(path.c_str());
+            if(dir) {
+                while(const dirent* entry = readdir(dir))
+                    result.insert(entry->d_name);
+                closedir(dir);
+            }
+            return result;
+        }
+#endif
+
+        /// Limit of the number of cached directories, the cache is started over when it is reached
+        static constexpr size_t max_directories = 256;
+
+        boost::mutex lock_;
+        /// Names of the files by path and encoding of the directory, empty for non-existing directories
+        std::map<std::pair<std::string, std::string>, std::set<std::string>> directories_;
+    };
+
+    void clear_catalog_directory_cache()
+    {
+        catalog_directory_cache::instance().clear();
+    }
+
     class mo_file {
     public:
-        mo_file(std::vector<char> data) : data_(std::move(data))
+        mo_file(catalog_buffer data) : data_(std::move(data))
         {
             if(data_.size() < 4)
                 throw std::runtime_error("invalid 'mo' file format - the file is too short");
@@ -139,12 +350,28 @@ namespace boost { namespace locale { namespace gnu_gettext {
             translations_offset_ = get(16);
             hash_size_ = get(20);
             hash_offset_ = get(24);
+            // Both tables have an entry of 8 bytes per string, check them before allocating anything by their size
+            if(keys_offset_ > data_.size() || size_ > (data_.size() - keys_offset_) / 8
+               || translations_offset_ > data_.size() || size_ > (data_.size() - translations_offset_) / 8)
+                throw std::runtime_error("Bad mo-file format");
         }
 
+        /// Value returned by \ref find_entry if the key was not found
+        static constexpr uint32_t npos = static_cast<uint32_t>(-1);
+
         core::string_view find(const char* context_in, const char* key_in) const
         {
-            if(!has_hash())
+            const uint32_t id = find_entry(context_in, key_in);
+            if(id == npos)
                 return {};
+            return value(id);
+        }
+
+        /// Get the index of the entry for the key or \ref npos if not found
+        uint32_t find_entry(const char* context_in, const char* key_in) const
+        {
+            if(!has_hash())
+                return npos;
 
             pj_winberger_hash::state_type st = pj_winberger_hash::initial_state;
             if(context_in) {
@@ -152,6 +379,8 @@ namespace boost { namespace locale { namespace gnu_gettext {
                 st = pj_winberger_hash::update_state(st, '\4'); // EOT
             }
             st = pj_winberger_hash::update_state(st, key_in);
+            if(!index_.empty())
+                return find_in_index(st, context_in, key_in);
             uint32_t hkey = st;
             const uint32_t incr = 1 + hkey % (hash_size_ - 2);
             hkey %= hash_size_;
@@ -161,14 +390,33 @@ namespace boost { namespace locale { namespace gnu_gettext {
                 const uint32_t idx = get(hash_offset_ + 4 * hkey);
                 // Not found
                 if(idx == 0)
-                    return {};
+                    return npos;
                 // If equal values return translation
                 if(key_equals(key(idx - 1), context_in, key_in))
-                    return value(idx - 1);
+                    return idx - 1;
                 // Rehash
                 hkey = (hkey + incr) % hash_size_;
             } while(hkey != orig_hkey);
-            return {};
+            return npos;
+        }
+
+        /// Build a hash table over the entries if the file does not contain one, e.g. created by `msgfmt --no-hash`
+        void build_index()
+        {
+            if(has_hash() || empty())
+                return;
+            // Keep the load factor below 50% for short probe sequences
+            size_t index_size = 4;
+            while(index_size < size_ * 2)
+                index_size *= 2;
+            index_.assign(index_size, 0);
+            const size_t mask = index_size - 1;
+            for(unsigned i = 0; i < size_; i++) {
+                size_t pos = pj_winberger_hash_function(key(i)) & mask;
+                while(index_[pos] != 0)
+                    pos = (pos + 1) & mask;
+                index_[pos] = i + 1;
+            }
         }
 
         static bool key_equals(const char* real_key, const char* cntx, const char* key)
@@ -192,6 +440,16 @@ namespace boost { namespace locale { namespace gnu_gettext {
             return data_.data() + off;
         }
 
+        /// The complete key including the plural form of the id after a NUL character if any
+        core::string_view full_key(unsigned id) const
+        {
+            const uint32_t len = get(keys_offset_ + id * 8);
+            const uint32_t off = get(keys_offset_ + id * 8 + 4);
+            if(len > data_.size() || off > data_.size() - len)
+                throw std::runtime_error("Bad mo-file format");
+            return core::string_view(&data_[off], len);
+        }
+
         core::string_view value(unsigned id) const
         {
             const uint32_t len = get(translations_offset_ + id * 8);
@@ -201,13 +459,26 @@ namespace boost { namespace locale { namespace gnu_gettext {
             return core::string_view(&data_[off], len);
         }
 
-        bool has_hash() const { return hash_size_ != 0; }
+        bool has_hash() const { return hash_size_ != 0 || !index_.empty(); }
 
         size_t size() const { return size_; }
 
         bool empty() const { return size_ == 0; }
 
     private:
+        uint32_t find_in_index(const uint32_t hkey, const char* context_in, const char* key_in) const
+        {
+            // Linear probing, there is always a free slot which terminates the search
+            const size_t mask = index_.size() - 1;
+            for(size_t pos = hkey & mask;; pos = (pos + 1) & mask) {
+                const uint32_t idx = index_[pos];
+                if(idx == 0)
+                    return npos;
+                if(key_equals(key(idx - 1), context_in, key_in))
+                    return idx - 1;
+            }
+        }
+
         uint32_t get(unsigned offset) const
         {
             if(offset > data_.size() - 4)
@@ -224,8 +495,9 @@ namespace boost { namespace locale { namespace gnu_gettext {
         uint32_t translations_offset_;
         uint32_t hash_size_;
         uint32_t hash_offset_;
+        std::vector<uint32_t> index_; ///< Entry indices + 1 by hash when the file has no hash table
 
-        const std::vector<char> data_;
+        const catalog_buffer data_;
         bool native_byteorder_;
         size_t size_;
     };
@@ -281,96 +553,313 @@ namespace boost { namespace locale { namespace gnu_gettext {
         using narrow_converter::operator();
     };
 
+    /// Message catalog converted to the target character type and encoding.
+    ///
+    /// All strings are stored in a single buffer and found via an open-addressing hash table of entry indices.
     template<typename CharType>
-    struct message_key {
+    class converted_catalog {
+    public:
         typedef std::basic_string<CharType> string_type;
+        typedef core::basic_string_view<CharType> string_view_type;
 
-        message_key(const string_type& c = string_type()) : c_context_(nullptr), c_key_(nullptr)
+        /// Add the translation \a value of \a key which has the format [context EOT] key.
+        /// Entries added later replace former ones with the same key once \ref build_index is called.
+        void add(const string_type& key, const string_type& value)
         {
-            const size_t pos = c.find(CharType(4));
-            if(pos == string_type::npos)
-                key_ = c;
-            else {
-                context_ = c.substr(0, pos);
-                key_ = c.substr(pos + 1);
+            const CharType* begin = key.c_str();
+            const CharType* const end = begin + key.size();
+            const CharType* const context_end = std::find(begin, end, CharType(4));
+            entry e;
+            if(context_end == end)
+                e.hash = hash(nullptr, nullptr, begin, end);
+            else if(context_end == begin) // Empty context is the same as no context
+                e.hash = hash(nullptr, nullptr, ++begin, end);
+            else
+                e.hash = hash(begin, context_end, context_end + 1, end);
+            e.key = offset(begin, end - begin);
+            e.value = offset(value.c_str(), value.size());
+            e.value_size = static_cast<uint32_t>(value.size());
+            entries_.push_back(e);
+        }
+
+        /// Create the lookup table after all entries were added
+        void build_index()
+        {
+            arena_.shrink_to_fit();
+            entries_.shrink_to_fit();
+            // Keep the load factor below 50% for short probe sequences
+            size_t index_size = 4;
+            while(index_size < entries_.size() * 2)
+                index_size *= 2;
+            index_.assign(index_size, 0);
+            const size_t mask = index_size - 1;
+            for(uint32_t i = 0; i < entries_.size(); i++) {
+                const entry& e = entries_[i];
+                for(size_t pos = e.hash & mask;; pos = (pos + 1) & mask) {
+                    uint32_t& slot = index_[pos];
+                    if(slot == 0 || is_same_key(entries_[slot - 1], e)) {
+                        slot = i + 1;
+                        break;
+                    }
+                }
             }
         }
-        message_key(const CharType* c, const CharType* k) : c_key_(k)
+
+        string_view_type find(const CharType* context, const CharType* key) const
         {
-            static const CharType empty = 0;
-            if(c != nullptr)
-                c_context_ = c;
-            else
-                c_context_ = &empty;
+            if(index_.empty())
+                return {};
+            if(context && *context == 0)
+                context = nullptr;
+            const CharType* const context_end = context ? util::str_end(context) : nullptr;
+            const uint32_t hkey = hash(context, context_end, key, util::str_end(key));
+            const size_t mask = index_.size() - 1;
+            for(size_t pos = hkey & mask;; pos = (pos + 1) & mask) {
+                const uint32_t idx = index_[pos];
+                if(idx == 0)
+                    return {};
+                const entry& e = entries_[idx - 1];
+                if(e.hash == hkey && key_equals(&arena_[e.key], context, key))
+                    return string_view_type(&arena_[e.value], e.value_size);
+            }
         }
-        bool operator<(const message_key& other) const
+
+    private:
+        struct entry {
+            uint32_t hash;
+            uint32_t key;   ///< Offset of the NULL terminated [context EOT] key in the arena
+            uint32_t value; ///< Offset of the value in the arena
+            uint32_t value_size;
+        };
+
+        uint32_t offset(const CharType* str, size_t len)
         {
-            const int cc = compare(context(), other.context());
-            if(cc != 0)
-                return cc < 0;
-            return compare(key(), other.key()) < 0;
+            const size_t result = arena_.size();
+            arena_.append(str, len);
+            arena_.push_back(CharType(0));
+            if(arena_.size() > std::numeric_limits<uint32_t>::max())
+                throw std::runtime_error("Message catalog is too large"); // LCOV_EXCL_LINE
+            return static_cast<uint32_t>(result);
         }
-        bool operator==(const message_key& other) const
+
+        bool is_same_key(const entry& lhs, const entry& rhs) const
         {
-            return compare(context(), other.context()) == 0 && compare(key(), other.key()) == 0;
+            if(lhs.hash != rhs.hash)
+                return false;
+            const CharType* l = &arena_[lhs.key];
+            const CharType* r = &arena_[rhs.key];
+            while(*l && *l == *r) {
+                ++l;
+                ++r;
+            }
+            return *l == *r;
         }
-        bool operator!=(const message_key& other) const { return !(*this == other); }
-        const CharType* context() const
+
+        static uint32_t
+        hash(const CharType* context, const CharType* context_end, const CharType* key, const CharType* key_end)
         {
-            if(c_context_)
-                return c_context_;
-            return context_.c_str();
+            pj_winberger_hash::state_type state = pj_winberger_hash::initial_state;
+            if(context != context_end) {
+                state = pj_winberger_hash::update_state(state,
+                                                        reinterpret_cast<const char*>(context),
+                                                        reinterpret_cast<const char*>(context_end));
+                state = pj_winberger_hash::update_state(state, '\4');
+            }
+            return pj_winberger_hash::update_state(state,
+                                                   reinterpret_cast<const char*>(key),
+                                                   reinterpret_cast<const char*>(key_end));
         }
-        const CharType* key() const
+
+        static bool key_equals(const CharType* real_key, const CharType* context, const CharType* key)
+        {
+            if(context) {
+                while(*context) {
+                    if(*real_key++ != *context++)
+                        return false;
+                }
+                if(*real_key++ != CharType(4))
+                    return false;
+            }
+            while(*key) {
+                if(*real_key++ != *key++)
+                    return false;
+            }
+            return *real_key == 0;
+        }
+
+        string_type arena_;
+        std::vector<entry> entries_;
+        std::vector<uint32_t> index_; ///< Entry indices + 1 by hash
+    };
+
+    /// Catalog for wide character types using an UTF-8 .mo file directly.
+    ///
+    /// Keys are converted to UTF-8 for the lookup and translations are converted on first use only.
+    /// The converted translations are stored in an append-only table which is safe for concurrent access.
+    /// All strings are validated on creation, so converting them later can't fail.
+    template<typename CharType>
+    class lazy_converted_catalog {
+    public:
+        typedef std::basic_string<CharType> string_type;
+        typedef core::basic_string_view<CharType> string_view_type;
+
+        /// \throws conv::conversion_error if any key or translation is not valid UTF-8, as converting all of them
+        /// at once would do
+        explicit lazy_converted_catalog(std::unique_ptr<mo_file> mo) :
+            mo_(std::move(mo)), values_(new std::atomic<string_type*>[mo_->size()])
+        {
+            for(size_t i = 0; i < mo_->size(); i++) {
+                values_[i].store(nullptr, std::memory_order_relaxed);
+                if(!is_valid_utf8(mo_->full_key(i)) || !is_valid_utf8(mo_->value(i)))
+                    throw conv::conversion_error();
+            }
+        }
+        ~lazy_converted_catalog()
+        {
+            for(size_t i = 0; i < mo_->size(); i++)
+                delete values_[i].load(std::memory_order_relaxed);
+        }
+
+        lazy_converted_catalog(const lazy_converted_catalog&) = delete;
+        lazy_converted_catalog& operator=(const lazy_converted_catalog&) = delete;
+
+        string_view_type find(const CharType* context, const CharType* key) const
         {
-            if(c_key_)
-                return c_key_;
-            return key_.c_str();
+            // Convert context and key into a buffer of the thread reused for all lookups to not allocate memory
+            std::string& buffer = lookup_buffer();
+            buffer.clear();
+            const bool has_context = context && *context;
+            size_t key_offset;
+            try {
+                if(has_context) {
+                    conv::utf_to_utf(context, util::str_end(context), buffer, conv::stop);
+                    buffer += '\0';
+                }
+                key_offset = buffer.size();
+                conv::utf_to_utf(key, util::str_end(key), buffer, conv::stop);
+            } catch(const conv::conversion_error&) {
+                return {}; // Can't match any of the valid keys
+            }
+            const uint32_t id = mo_->find_entry(has_context ? buffer.c_str() : nullptr, buffer.c_str() + key_offset);
+            if(id == mo_file::npos)
+                return {};
+
+            const string_type* value = values_[id].load(std::memory_order_acquire);
+            if(!value) {
+                const core::string_view utf8_value = mo_->value(id);
+                std::unique_ptr<string_type> converted(new string_type(
+                  conv::utf_to_utf<CharType>(utf8_value.data(), utf8_value.data() + utf8_value.size(), conv::stop)));
+                string_type* expected = nullptr;
+                // Another thread might have been faster in which case its value is used
+                if(values_[id].compare_exchange_strong(expected, converted.get(), std::memory_order_acq_rel))
+                    value = converted.release();
+                else
+                    value = expected;
+            }
+            return *value;
         }
 
     private:
-        static int compare(const CharType* l, const CharType* r)
+        static bool is_valid_utf8(const core::string_view s)
         {
-            typedef std::char_traits<CharType> traits_type;
-            for(;;) {
-                const CharType cl = *l++;
-                const CharType cr = *r++;
-                if(cl == 0 && cr == 0)
-                    return 0;
-                if(traits_type::lt(cl, cr))
-                    return -1;
-                if(traits_type::lt(cr, cl))
-                    return 1;
+            const char* begin = s.data();
+            const char* const end = begin + s.size();
+            while(begin != end) {
+                const utf::code_point c = utf::utf_traits<char>::decode(begin, end);
+                if(c == utf::illegal || c == utf::incomplete)
+                    return false;
+            }
+            return true;
+        }
+
+        static std::string& lookup_buffer()
+        {
+            static boost::thread_specific_ptr<std::string> buffers;
+            std::string* buffer = buffers.get();
+            if(!buffer) {
+                buffer = new std::string();
+                buffers.reset(buffer);
             }
+            return *buffer;
         }
-        string_type context_;
-        string_type key_;
-        const CharType* c_context_;
-        const CharType* c_key_;
+
+        const std::unique_ptr<mo_file> mo_;
+        const std::unique_ptr<std::atomic<string_type*>[]> values_; ///< Converted translations by entry index
     };
 
+    /// Cache of lookup results in a catalog by the addresses of the strings used for the lookup.
+    ///
+    /// Each slot is written once and never changed afterwards, so lookups are lock-free.
+    /// If the slot for a key is already used by another key the result is not cached.
     template<typename CharType>
-    struct hash_function {
-        size_t operator()(const message_key<CharType>& msg) const
+    class address_cache {
+    public:
+        typedef core::basic_string_view<CharType> string_view_type;
+
+        address_cache()
         {
-            pj_winberger_hash::state_type state = pj_winberger_hash::initial_state;
-            const CharType* p = msg.context();
-            if(*p != 0) {
-                const CharType* e = util::str_end(p);
-                state = pj_winberger_hash::update_state(state,
-                                                        reinterpret_cast<const char*>(p),
-                                                        reinterpret_cast<const char*>(e));
-                state = pj_winberger_hash::update_state(state, '\4');
-            }
-            p = msg.key();
-            const CharType* e = util::str_end(p);
-            state = pj_winberger_hash::update_state(state,
-                                                    reinterpret_cast<const char*>(p),
-                                                    reinterpret_cast<const char*>(e));
-            return state;
+            for(auto& slot : slots_)
+                slot.store(nullptr, std::memory_order_relaxed);
+        }
+        ~address_cache()
+        {
+            for(auto& slot : slots_)
+                delete slot.load(std::memory_order_relaxed);
+        }
+
+        address_cache(const address_cache&) = delete;
+        address_cache& operator=(const address_cache&) = delete;
+
+        bool find(const CharType* context, const CharType* id, string_view_type& result) const
+        {
+            const entry* e = slots_[slot_index(context, id)].load(std::memory_order_acquire);
+            if(!e || e->context != context || e->id != id)
+                return false;
+            result = e->result;
+            return true;
+        }
+
+        void add(const CharType* context, const CharType* id, string_view_type result)
+        {
+            auto& slot = slots_[slot_index(context, id)];
+            if(slot.load(std::memory_order_relaxed))
+                return;
+            std::unique_ptr<entry> e(new entry{context, id, result});
+            const entry* expected = nullptr;
+            if(slot.compare_exchange_strong(expected, e.get(), std::memory_order_acq_rel))
+                e.release();
+        }
+
+    private:
+        struct entry {
+            const CharType* context;
+            const CharType* id;
+            string_view_type result;
+        };
+        static constexpr unsigned size_bits = 9;
+
+        static size_t slot_index(const CharType* context, const CharType* id)
+        {
+            uint64_t h = reinterpret_cast<uintptr_t>(id);
+            h ^= reinterpret_cast<uintptr_t>(context) << 1;
+            // Fibonacci hashing to use the well mixed upper bits
+            return static_cast<size_t>((h * 0x9E3779B97F4A7C15ull) >> (64 - size_bits));
         }
+
+        std::atomic<const entry*> slots_[size_t(1) << size_bits];
     };
 
+    /// Get the value of the field starting with \a key from the .mo header \a meta
+    std::string extract_header_field(core::string_view meta, const std::string& key, const core::string_view separators)
+    {
+        const size_t pos = meta.find(key);
+        if(pos == core::string_view::npos)
+            return "";
+        meta.remove_prefix(pos + key.size());
+        const size_t end_pos = meta.find_first_of(separators);
+        return std::string(meta.substr(0, end_pos));
+    }
+
     // By default for wide types the conversion is not required
     template<typename CharType>
     const CharType* runtime_conversion(const CharType* msg,
@@ -401,12 +890,19 @@ namespace boost { namespace locale { namespace gnu_gettext {
     template<typename CharType>
     class mo_message : public message_format<CharType> {
         typedef std::basic_string<CharType> string_type;
-        typedef message_key<CharType> key_type;
-        typedef std::unordered_map<key_type, string_type, hash_function<CharType>> catalog_type;
+        typedef converted_catalog<CharType> catalog_type;
         struct domain_data_type {
             std::unique_ptr<mo_file> mo_catalog; /// Message catalog (.mo file) if it can be directly used
-            catalog_type catalog;                /// Converted message catalog when .mo file cannot be directly used
-            lambda::plural_expr plural_form;     /// Expression to determine the plural form index
+            std::unique_ptr<lazy_converted_catalog<CharType>> lazy_catalog; /// UTF-8 .mo file for wide characters
+            catalog_type catalog;            /// Converted message catalog when .mo file cannot be directly used
+            lambda::plural_expr plural_form; /// Expression to determine the plural form index
+            std::unique_ptr<address_cache<CharType>> literal_cache; /// Lookups by string address if enabled
+            std::string file_name; /// File the catalog was loaded from, empty if none was found
+            file_stamp stamp;      /// Modification time and size of that file, if loaded from the file system
+            buffer_stamp content;  /// Content of the catalog, if provided by a callback
+
+            /// Check if the content of the catalog buffer is still referenced, so its address identifies it
+            bool uses_buffer() const { return mo_catalog || lazy_catalog; }
         };
 
     public:
@@ -414,34 +910,40 @@ namespace boost { namespace locale { namespace gnu_gettext {
 
         const CharType* get(int domain_id, const CharType* context, const CharType* in_id) const override
         {
-            const auto result = get_string(domain_id, context, in_id);
+            const domain_data_type* data = get_domain_data(domain_id);
+            if(!data)
+                return nullptr;
+            const auto result = get_string(*data, context, in_id);
             return result.empty() ? nullptr : result.data();
         }
 
         const CharType*
         get(int domain_id, const CharType* context, const CharType* single_id, count_type n) const override
         {
-            auto result = get_string(domain_id, context, single_id);
-            if(result.empty())
+            const domain_data_type* data = get_domain_data(domain_id);
+            if(!data)
                 return nullptr;
+            return select_plural(*data, get_string(*data, context, single_id), n);
+        }
 
-            // domain_id is already checked by get_string -> Would return a null-pair
-            BOOST_ASSERT(domain_id >= 0 && static_cast<size_t>(domain_id) < domain_data_.size());
-            lambda::expr::value_type plural_idx;
-            if(domain_data_[domain_id].plural_form)
-                plural_idx = domain_data_[domain_id].plural_form(n);
-            else
-                plural_idx = n == 1 ? 0 : 1; // Fallback to English plural form
-
-            for(decltype(plural_idx) i = 0; i < plural_idx; ++i) {
-                const auto pos = result.find(CharType(0));
-                if(BOOST_UNLIKELY(pos == string_view_type::npos))
-                    return nullptr;
-                result.remove_prefix(pos + 1);
-            }
+        const CharType* get_literal(int domain_id, const CharType* context, const CharType* in_id) const override
+        {
+            const domain_data_type* data = get_domain_data(domain_id);
+            if(!data)
+                return nullptr;
+            const auto result = get_cached_string(*data, context, in_id);
             return result.empty() ? nullptr : result.data();
         }
 
+        const CharType*
+        get_literal(int domain_id, const CharType* context, const CharType* single_id, count_type n) const override
+        {
+            const domain_data_type* data = get_domain_data(domain_id);
+            if(!data)
+                return nullptr;
+            return select_plural(*data, get_cached_string(*data, context, single_id), n);
+        }
+
         int domain(const std::string& domain) const override
         {
             const auto p = domains_.find(domain);
@@ -450,20 +952,25 @@ namespace boost { namespace locale { namespace gnu_gettext {
             return p->second;
         }
 
-        mo_message(const messages_info& inf) : key_conversion_required_(false)
+        mo_message(const messages_info& inf) :
+            info_(inf), catalog_paths_(inf.get_catalog_paths()),
+            domain_data_(new std::atomic<const domain_data_type*>[inf.domains.size()]),
+            load_errors_(new std::exception_ptr[inf.domains.size()]), key_conversion_required_(false)
         {
-            const std::vector<messages_info::domain>& domains = inf.domains;
-            domain_data_.resize(domains.size());
-
-            const auto catalog_paths = inf.get_catalog_paths();
-            for(unsigned i = 0; i < domains.size(); i++) {
-                const auto& domain = domains[i];
+            locale_encoding_ = util::is_char8_t<CharType>::value ? "UTF-8" : inf.encoding;
+            for(unsigned i = 0; i < inf.domains.size(); i++) {
+                const auto& domain = inf.domains[i];
                 domains_[domain.name] = i;
-                const std::string filename = domain.name + ".mo";
-                for(std::string path : catalog_paths) {
-                    path += "/" + filename;
-                    if(load_file(path, inf.encoding, domain.encoding, domain_data_[i], inf.callback))
-                        break;
+                if(!catalog_paths_.empty()) {
+                    key_encoding_ = domain.encoding;
+                    key_conversion_required_ =
+                      sizeof(CharType) == 1 && !util::are_encodings_equal(inf.encoding, domain.encoding);
+                }
+                if(inf.lazy_loading)
+                    domain_data_[i].store(nullptr, std::memory_order_relaxed);
+                else {
+                    catalogs_.push_back(load_domain(domain, nullptr));
+                    domain_data_[i].store(catalogs_.back().get(), std::memory_order_relaxed);
                 }
             }
         }
@@ -473,38 +980,91 @@ namespace boost { namespace locale { namespace gnu_gettext {
             return runtime_conversion<CharType>(msg, buffer, key_conversion_required_, locale_encoding_, key_encoding_);
         }
 
-    private:
-        bool load_file(const std::string& file_name,
-                       const std::string& locale_encoding,
-                       const std::string& key_encoding,
-                       domain_data_type& data,
-                       const messages_info::callback_type& callback)
+        /// Load the catalogs which changed since they were loaded and publish them for new lookups.
+        /// Replaced catalogs are kept alive as translations returned before may still be in use.
+        /// Pointers to them are handed out without tracking, so they can't be released before the facet.
+        bool reload() const
         {
-            locale_encoding_ = util::is_char8_t<CharType>::value ? "UTF-8" : locale_encoding;
-            key_encoding_ = key_encoding;
-
-            key_conversion_required_ =
-              sizeof(CharType) == 1 && !util::are_encodings_equal(locale_encoding, key_encoding);
-
-            std::unique_ptr<mo_file> mo;
+            boost::unique_lock<boost::mutex> guard(reload_lock_);
+            bool reloaded = false;
+            for(unsigned i = 0; i < info_.domains.size(); i++) {
+                const domain_data_type* current = domain_data_[i].load(std::memory_order_relaxed);
+                if(!current) {
+                    load_errors_[i] = nullptr; // Retry loading a catalog which failed to load on next use
+                    continue;                  // Not yet loaded, so the current catalog will be loaded on first use
+                }
+                std::unique_ptr<domain_data_type> data = load_domain(info_.domains[i], current);
+                if(data) {
+                    catalogs_.push_back(std::move(data));
+                    domain_data_[i].store(catalogs_.back().get(), std::memory_order_release);
+                    reloaded = true;
+                }
+            }
+            return reloaded;
+        }
 
-            {
-                std::vector<char> file_data;
-                if(callback)
-                    file_data = callback(file_name, locale_encoding);
+    private:
+        /// Load the catalog of the \a domain from the first catalog path containing it.
+        /// Returns nullptr if it would be loaded from the same unmodified file as \a current
+        std::unique_ptr<domain_data_type> load_domain(const messages_info::domain& domain,
+                                                      const domain_data_type* current) const
+        {
+            const std::string filename = domain.name + ".mo";
+            for(const std::string& directory : catalog_paths_) {
+                const std::string path = directory + "/" + filename;
+                std::unique_ptr<domain_data_type> data(new domain_data_type);
+                catalog_buffer file_data;
+                if(info_.buffer_callback)
+                    file_data = info_.buffer_callback(path, info_.encoding);
+                else if(info_.callback)
+                    file_data = catalog_buffer(info_.callback(path, info_.encoding));
                 else {
-                    c_file the_file(file_name, locale_encoding);
+                    if(info_.cache_catalog_directories
+                       && !catalog_directory_cache::instance().contains(directory, filename, info_.encoding))
+                        continue;
+                    c_file the_file(path, info_.encoding);
                     if(!the_file.handle)
-                        return false;
-                    file_data = read_file(the_file.handle);
+                        continue;
+                    data->stamp = get_file_stamp(the_file.handle);
+                    if(current && current->file_name == path && current->stamp == data->stamp)
+                        return nullptr;
+                    if(info_.use_memory_mapping)
+                        file_data = map_file(the_file.handle);
+                    if(file_data.empty())
+                        file_data = catalog_buffer(read_file(the_file.handle));
                 }
                 if(file_data.empty())
-                    return false;
-                mo.reset(new mo_file(std::move(file_data)));
+                    continue;
+                if(info_.buffer_callback || info_.callback) {
+                    // Skip unchanged content to not keep another copy of it on each reload
+                    const bool same_file = current && current->file_name == path;
+                    if(same_file && current->uses_buffer() && current->content.data == file_data.data()
+                       && current->content.size == file_data.size())
+                        return nullptr;
+                    data->content = buffer_stamp(file_data);
+                    if(same_file && current->content.size == data->content.size
+                       && current->content.hash == data->content.hash)
+                        return nullptr;
+                }
+                data->file_name = path;
+                detail::instrumentation().catalog_loaded(path, file_data.size());
+                load_catalog(std::move(file_data), domain.encoding, *data);
+                return data;
             }
+            if(current && current->file_name.empty())
+                return nullptr;
+            std::unique_ptr<domain_data_type> data(new domain_data_type);
+            if(info_.cache_literal_lookups)
+                data->literal_cache.reset(new address_cache<CharType>());
+            return data;
+        }
 
-            const std::string plural = extract(mo->value(0), "plural=", "\r\n;");
-            const std::string mo_encoding = extract(mo->value(0), "charset=", " \r\n;");
+        void load_catalog(catalog_buffer file_data, const std::string& key_encoding, domain_data_type& data) const
+        {
+            std::unique_ptr<mo_file> mo(new mo_file(std::move(file_data)));
+
+            const std::string plural = extract_header_field(mo->value(0), "plural=", "\r\n;");
+            const std::string mo_encoding = extract_header_field(mo->value(0), "charset=", " \r\n;");
 
             if(mo_encoding.empty())
                 throw std::runtime_error("Invalid mo-format, encoding is not specified");
@@ -512,19 +1072,19 @@ namespace boost { namespace locale { namespace gnu_gettext {
             if(!plural.empty())
                 data.plural_form = lambda::compile(plural.c_str());
 
-            if(mo_useable_directly(mo_encoding, *mo))
+            if(mo_useable_directly(mo_encoding, key_encoding, *mo))
                 data.mo_catalog = std::move(mo);
+            else if(mo_useable_lazily(mo_encoding, *mo))
+                data.lazy_catalog.reset(new lazy_converted_catalog<CharType>(std::move(mo)));
             else {
-                converter<CharType> cvt_value(locale_encoding, mo_encoding);
+                converter<CharType> cvt_value(info_.encoding, mo_encoding);
                 converter<CharType> cvt_key(key_encoding, mo_encoding);
-                for(unsigned i = 0; i < mo->size(); i++) {
-                    const char* ckey = mo->key(i);
-                    const key_type key(cvt_key(ckey));
-
-                    data.catalog[key] = cvt_value(mo->value(i));
-                }
+                for(unsigned i = 0; i < mo->size(); i++)
+                    data.catalog.add(cvt_key(mo->key(i)), cvt_value(mo->value(i)));
+                data.catalog.build_index();
             }
-            return true;
+            if(info_.cache_literal_lookups)
+                data.literal_cache.reset(new address_cache<CharType>());
         }
 
         // Check if the mo file as-is is useful
@@ -532,57 +1092,124 @@ namespace boost { namespace locale { namespace gnu_gettext {
         // 2. The locale encoding and mo encoding is same
         // 3. The source strings encoding and mo encoding is same or all
         //    mo key strings are US-ASCII
-        bool mo_useable_directly(const std::string& mo_encoding, const mo_file& mo)
+        // If it is, a hash table for lookups is created if the file does not contain one
+        bool mo_useable_directly(const std::string& mo_encoding, const std::string& key_encoding, mo_file& mo) const
         {
             BOOST_LOCALE_START_CONST_CONDITION
             if(sizeof(CharType) != 1)
                 return false;
             BOOST_LOCALE_END_CONST_CONDITION
-            if(!mo.has_hash())
-                return false;
             if(!util::are_encodings_equal(mo_encoding, locale_encoding_))
                 return false;
-            if(util::are_encodings_equal(mo_encoding, key_encoding_))
-                return true;
-            for(unsigned i = 0; i < mo.size(); i++) {
-                if(!detail::is_us_ascii_string(mo.key(i)))
-                    return false;
+            if(!util::are_encodings_equal(mo_encoding, key_encoding)) {
+                for(unsigned i = 0; i < mo.size(); i++) {
+                    if(!detail::is_us_ascii_string(mo.key(i)))
+                        return false;
+                }
             }
+            mo.build_index();
             return true;
         }
 
-        static std::string extract(core::string_view meta, const std::string& key, const core::string_view separators)
+        // Check if the mo file can be used by converting keys and translations on demand:
+        // Wide characters which are always UTF and an UTF-8 mo file
+        static bool mo_useable_lazily(const std::string& mo_encoding, mo_file& mo)
         {
-            const size_t pos = meta.find(key);
-            if(pos == core::string_view::npos)
-                return "";
-            meta.remove_prefix(pos + key.size());
-            const size_t end_pos = meta.find_first_of(separators);
-            return std::string(meta.substr(0, end_pos));
+            BOOST_LOCALE_START_CONST_CONDITION
+            if(sizeof(CharType) == 1)
+                return false;
+            BOOST_LOCALE_END_CONST_CONDITION
+            if(!util::are_encodings_equal(mo_encoding, "UTF-8"))
+                return false;
+            mo.build_index();
+            return true;
         }
 
-        string_view_type get_string(int domain_id, const CharType* context, const CharType* in_id) const
+        const domain_data_type* get_domain_data(int domain_id) const
         {
-            if(domain_id < 0 || static_cast<size_t>(domain_id) >= domain_data_.size())
-                return {};
-            const auto& data = domain_data_[domain_id];
+            if(domain_id < 0 || static_cast<size_t>(domain_id) >= info_.domains.size())
+                return nullptr;
+            const domain_data_type* data = domain_data_[domain_id].load(std::memory_order_acquire);
+            return BOOST_LIKELY(data != nullptr) ? data : load_domain_data(domain_id);
+        }
 
+        /// Load the catalog of a domain on first use when loading lazily.
+        /// A failure is rethrown on each use without reading the catalog again until it is reloaded.
+        BOOST_NOINLINE const domain_data_type* load_domain_data(int domain_id) const
+        {
+            boost::unique_lock<boost::mutex> guard(reload_lock_);
+            const domain_data_type* data = domain_data_[domain_id].load(std::memory_order_relaxed);
+            if(!data) {
+                std::exception_ptr& error = load_errors_[domain_id];
+                if(error)
+                    std::rethrow_exception(error);
+                try {
+                    catalogs_.push_back(load_domain(info_.domains[domain_id], nullptr));
+                } catch(...) {
+                    error = std::current_exception();
+                    throw;
+                }
+                data = catalogs_.back().get();
+                domain_data_[domain_id].store(data, std::memory_order_release);
+            }
+            return data;
+        }
+
+        static string_view_type get_string(const domain_data_type& data, const CharType* context, const CharType* in_id)
+        {
             BOOST_LOCALE_START_CONST_CONDITION
             if(mo_file_use_traits<CharType>::in_use && data.mo_catalog) {
                 BOOST_LOCALE_END_CONST_CONDITION
                 return mo_file_use_traits<CharType>::use(*data.mo_catalog, context, in_id);
-            } else {
-                const key_type key(context, in_id);
-                const catalog_type& cat = data.catalog;
-                const auto p = cat.find(key);
-                if(p == cat.end())
-                    return {};
-                return p->second;
+            } else if(data.lazy_catalog)
+                return data.lazy_catalog->find(context, in_id);
+            else
+                return data.catalog.find(context, in_id);
+        }
+
+        static string_view_type
+        get_cached_string(const domain_data_type& data, const CharType* context, const CharType* in_id)
+        {
+            if(!data.literal_cache)
+                return get_string(data, context, in_id);
+            string_view_type result;
+            if(!data.literal_cache->find(context, in_id, result)) {
+                result = get_string(data, context, in_id);
+                data.literal_cache->add(context, in_id, result);
+            }
+            return result;
+        }
+
+        static const CharType* select_plural(const domain_data_type& data, string_view_type translation, count_type n)
+        {
+            if(translation.empty())
+                return nullptr;
+
+            lambda::plural_expr::value_type plural_idx;
+            if(data.plural_form)
+                plural_idx = data.plural_form(n);
+            else
+                plural_idx = n == 1 ? 0 : 1; // Fallback to English plural form
+
+            for(decltype(plural_idx) i = 0; i < plural_idx; ++i) {
+                const auto pos = translation.find(CharType(0));
+                if(BOOST_UNLIKELY(pos == string_view_type::npos))
+                    return nullptr;
+                translation.remove_prefix(pos + 1);
             }
+            return translation.empty() ? nullptr : translation.data();
         }
 
+        const messages_info info_;
+        const std::vector<std::string> catalog_paths_;
         std::map<std::string, unsigned> domains_;
-        std::vector<domain_data_type> domain_data_;
+        /// Current catalog of each domain, replaced on reload and null until loaded when loading lazily
+        const std::unique_ptr<std::atomic<const domain_data_type*>[]> domain_data_;
+        /// Error of loading the catalog of each domain on first use, cleared on reload
+        const std::unique_ptr<std::exception_ptr[]> load_errors_;
+        /// All catalogs ever loaded, including replaced ones
+        mutable std::vector<std::unique_ptr<domain_data_type>> catalogs_;
+        mutable boost::mutex reload_lock_;
 
         std::string locale_encoding_;
         std::string key_encoding_;
@@ -595,8 +1222,120 @@ namespace boost { namespace locale { namespace gnu_gettext {
         return new mo_message<CharType>(info);
     }
 
-#define BOOST_LOCALE_INSTANTIATE(CHARTYPE) \
-    template BOOST_LOCALE_DECL message_format<CHARTYPE>* create_messages_facet(const messages_info& info);
+    template<typename CharType, class /* enable_if */>
+    bool reload_messages_catalogs(const std::locale& loc)
+    {
+        if(!std::has_facet<message_format<CharType>>(loc))
+            return false;
+        const auto* facet = dynamic_cast<const mo_message<CharType>*>(&std::use_facet<message_format<CharType>>(loc));
+        return facet && facet->reload();
+    }
+
+    /// Smallest prime not less than \a n which is at least 3
+    static uint32_t next_prime(uint32_t n)
+    {
+        if(n <= 3)
+            return 3;
+        for(n |= 1;; n += 2) {
+            bool is_prime = true;
+            for(uint32_t d = 3; d <= n / d && is_prime; d += 2)
+                is_prime = n % d != 0;
+            if(is_prime)
+                return n;
+        }
+    }
+
+    std::vector<char> prepare_catalog(catalog_buffer catalog, const std::string& encoding)
+    {
+        const mo_file mo(std::move(catalog));
+        if(mo.empty())
+            throw std::runtime_error("Invalid mo-format, header is missing");
+        const std::string mo_encoding = extract_header_field(mo.value(0), "charset=", " \r\n;");
+        if(mo_encoding.empty())
+            throw std::runtime_error("Invalid mo-format, encoding is not specified");
+
+        const uint32_t num_entries = static_cast<uint32_t>(mo.size());
+        std::vector<std::string> keys(num_entries), values(num_entries);
+        const bool conversion_required = !util::are_encodings_equal(mo_encoding, encoding);
+        // Fail on characters which can't be represented, so the prepared catalog has the same entries
+        std::unique_ptr<conv::narrow_converter> cvt;
+        if(conversion_required)
+            cvt.reset(new conv::narrow_converter(mo_encoding, encoding, conv::stop));
+        // Convert the NUL separated parts of keys and values (plural forms) separately
+        const auto convert = [&cvt](const core::string_view str) {
+            std::string result;
+            for(size_t begin = 0;;) {
+                const size_t end = std::min(str.find('\0', begin), str.size());
+                result += (*cvt)(str.substr(begin, end - begin));
+                if(end == str.size())
+                    return result;
+                result += '\0';
+                begin = end + 1;
+            }
+        };
+        for(uint32_t i = 0; i < num_entries; i++) {
+            const core::string_view key = mo.full_key(i);
+            const core::string_view value = mo.value(i);
+            keys[i] = conversion_required ? convert(key) : std::string(key);
+            values[i] = conversion_required ? convert(value) : std::string(value);
+            if(keys[i].empty()) { // The header
+                const size_t pos = values[i].find("charset=");
+                if(pos != std::string::npos) {
+                    const size_t begin = pos + 8;
+                    const size_t end = values[i].find_first_of(" \r\n;", begin);
+                    values[i].replace(begin, (end == std::string::npos ? values[i].size() : end) - begin, encoding);
+                }
+            }
+        }
+
+        // Layout: header, tables of keys and values (length & offset), hash table, strings
+        const uint32_t hash_size = next_prime(num_entries + num_entries / 3 + 1);
+        const size_t keys_offset = 28;
+        const size_t values_offset = keys_offset + 8 * size_t(num_entries);
+        const size_t hash_offset = values_offset + 8 * size_t(num_entries);
+        std::vector<char> result(hash_offset + 4 * size_t(hash_size), '\0');
+        const auto put = [&result](size_t offset, size_t value) {
+            if(value > std::numeric_limits<uint32_t>::max())
+                throw std::runtime_error("Message catalog is too large"); // LCOV_EXCL_LINE
+            const uint32_t v = static_cast<uint32_t>(value);
+            memcpy(&result[offset], &v, sizeof(v));
+        };
+        const auto add_string = [&](const std::string& str, size_t table_offset) {
+            put(table_offset, str.size());
+            put(table_offset + 4, result.size());
+            result.insert(result.end(), str.begin(), str.end());
+            result.push_back('\0');
+        };
+        put(0, 0x950412de); // Magic number in native byte order
+        put(4, 0);          // Revision
+        put(8, num_entries);
+        put(12, keys_offset);
+        put(16, values_offset);
+        put(20, hash_size);
+        put(24, hash_offset);
+        for(uint32_t i = 0; i < num_entries; i++) {
+            add_string(keys[i], keys_offset + 8 * size_t(i));
+            add_string(values[i], values_offset + 8 * size_t(i));
+
+            // Double hashing as used by GNU gettext
+            const uint32_t hkey = pj_winberger_hash_function(keys[i].c_str());
+            const uint32_t incr = 1 + hkey % (hash_size - 2);
+            uint32_t pos = hkey % hash_size;
+            for(;;) {
+                uint32_t idx;
+                memcpy(&idx, &result[hash_offset + 4 * size_t(pos)], sizeof(idx));
+                if(idx == 0)
+                    break;
+                pos = (pos + incr) % hash_size;
+            }
+            put(hash_offset + 4 * size_t(pos), i + 1);
+        }
+        return result;
+    }
+
+#define BOOST_LOCALE_INSTANTIATE(CHARTYPE)                                                                 \
+    template BOOST_LOCALE_DECL message_format<CHARTYPE>* create_messages_facet(const messages_info& info); \
+    template BOOST_LOCALE_DECL bool reload_messages_catalogs<CHARTYPE>(const std::locale& loc);
 
     BOOST_LOCALE_FOREACH_CHAR_STRING(BOOST_LOCALE_INSTANTIATE)
 
@@ -606,16 +1345,19 @@ namespace boost { namespace locale { namespace detail {
     std::locale install_message_facet(const std::locale& in,
                                       const char_facet_t type,
                                       const util::locale_data& data,
-                                      const std::vector<std::string>& domains,
-                                      const std::vector<std::string>& paths)
+                                      const message_options& options)
     {
         gnu_gettext::messages_info minf;
         minf.language = data.language();
         minf.country = data.country();
         minf.variant = data.variant();
         minf.encoding = data.encoding();
-        minf.domains = gnu_gettext::messages_info::domains_type(domains.begin(), domains.end());
-        minf.paths = paths;
+        minf.domains = gnu_gettext::messages_info::domains_type(options.domains.begin(), options.domains.end());
+        minf.paths = options.paths;
+        minf.use_memory_mapping = options.use_memory_mapping;
+        minf.cache_literal_lookups = options.cache_literal_lookups;
+        minf.lazy_loading = options.lazy_loading;
+        minf.cache_catalog_directories = options.cache_catalog_directories;
         switch(type) {
             case char_facet_t::nochar: break;
             case char_facet_t::char_f: return std::locale(in, gnu_gettext::create_messages_facet<char>(minf));
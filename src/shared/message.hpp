@@ -14,11 +14,46 @@
 #include <vector>
 
 namespace boost { namespace locale { namespace detail {
+    /// Options of the message facet as passed to the backends by the generator
+    struct message_options {
+        message_options() :
+            use_memory_mapping(false), cache_literal_lookups(false), lazy_loading(false),
+            cache_catalog_directories(false)
+        {}
+
+        std::vector<std::string> domains;
+        std::vector<std::string> paths;
+        bool use_memory_mapping;
+        bool cache_literal_lookups;
+        bool lazy_loading;
+        bool cache_catalog_directories;
+
+        /// Handle the backend option \a name if it is a message option and return whether it was
+        bool set_option(const std::string& name, const std::string& value)
+        {
+            if(name == "message_path")
+                paths.push_back(value);
+            else if(name == "message_application")
+                domains.push_back(value);
+            else if(name == "message_memory_mapping")
+                use_memory_mapping = value == "true";
+            else if(name == "message_cache_literal_lookups")
+                cache_literal_lookups = value == "true";
+            else if(name == "message_lazy_loading")
+                lazy_loading = value == "true";
+            else if(name == "message_cache_directories")
+                cache_catalog_directories = value == "true";
+            else
+                return false;
+            return true;
+        }
+        void clear() { *this = message_options(); }
+    };
+
     std::locale install_message_facet(const std::locale& in,
                                       char_facet_t type,
                                       const util::locale_data& data,
-                                      const std::vector<std::string>& domains,
-                                      const std::vector<std::string>& paths);
+                                      const message_options& options);
 }}} // namespace boost::locale::detail
 
 #endif
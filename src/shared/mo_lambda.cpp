@@ -12,6 +12,7 @@
 #include <cstring>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <stdexcept>
 
 #ifdef BOOST_MSVC
@@ -21,90 +22,36 @@
 namespace boost { namespace locale { namespace gnu_gettext { namespace lambda {
 
     namespace { // anon
-        template<class TExp, typename... Ts>
-        expr_ptr make_expr(Ts&&... ts)
-        {
-            return expr_ptr(new TExp(std::forward<Ts>(ts)...));
-        }
-
-        struct identity final : expr {
-            value_type operator()(value_type n) const override { return n; }
-        };
-
-        using sub_expr_type = plural_expr;
+        using value_type = plural_expr::value_type;
+        using opcode = plural_expr::opcode;
 
         template<class Functor>
-        struct unary final : expr, Functor {
-            unary(expr_ptr p) : op1(std::move(p)) {}
-            value_type operator()(value_type n) const override { return Functor::operator()(op1(n)); }
-
-        protected:
-            sub_expr_type op1;
-        };
-
-        template<class Functor, bool returnZeroOnZero2ndArg = false>
-        struct binary final : expr, Functor {
-            binary(expr_ptr p1, expr_ptr p2) : op1(std::move(p1)), op2(std::move(p2)) {}
-            value_type operator()(value_type n) const override
-            {
-                const auto v1 = op1(n);
-                const auto v2 = op2(n);
-                BOOST_LOCALE_START_CONST_CONDITION
-                if(returnZeroOnZero2ndArg && v2 == 0)
-                    return 0;
-                BOOST_LOCALE_END_CONST_CONDITION
-                return Functor::operator()(v1, v2);
-            }
-
-        protected:
-            sub_expr_type op1, op2;
-        };
-
-        struct number final : expr {
-            number(value_type v) : val(v) {}
-            value_type operator()(value_type /*n*/) const override { return val; }
-
-        private:
-            value_type val;
-        };
-
-        struct conditional final : public expr {
-            conditional(expr_ptr p1, expr_ptr p2, expr_ptr p3) :
-                op1(std::move(p1)), op2(std::move(p2)), op3(std::move(p3))
-            {}
-            value_type operator()(value_type n) const override { return op1(n) ? op2(n) : op3(n); }
-
-        private:
-            sub_expr_type op1, op2, op3;
-        };
+        value_type apply(const value_type* args)
+        {
+            return Functor()(args[0], args[1]);
+        }
 
         using token_t = int;
         enum : token_t { END = 0, GTE = 256, LTE, EQ, NEQ, AND, OR, NUM, VARIABLE };
 
-        expr_ptr bin_factory(const token_t value, expr_ptr left, expr_ptr right)
+        opcode binary_opcode(const token_t value)
         {
-#define BINOP_CASE(match, cls) \
-    case match: return make_expr<cls>(std::move(left), std::move(right))
-            // Special cases: Avoid division by zero
-            using divides = binary<std::divides<expr::value_type>, true>;
-            using modulus = binary<std::modulus<expr::value_type>, true>;
             switch(value) {
-                BINOP_CASE('/', divides);
-                BINOP_CASE('*', binary<std::multiplies<expr::value_type>>);
-                BINOP_CASE('%', modulus);
-                BINOP_CASE('+', binary<std::plus<expr::value_type>>);
-                BINOP_CASE('-', binary<std::minus<expr::value_type>>);
-                BINOP_CASE('>', binary<std::greater<expr::value_type>>);
-                BINOP_CASE('<', binary<std::less<expr::value_type>>);
-                BINOP_CASE(GTE, binary<std::greater_equal<expr::value_type>>);
-                BINOP_CASE(LTE, binary<std::less_equal<expr::value_type>>);
-                BINOP_CASE(EQ, binary<std::equal_to<expr::value_type>>);
-                BINOP_CASE(NEQ, binary<std::not_equal_to<expr::value_type>>);
-                BINOP_CASE(AND, binary<std::logical_and<expr::value_type>>);
-                BINOP_CASE(OR, binary<std::logical_or<expr::value_type>>);
+                case '/': return opcode::divides;
+                case '*': return opcode::multiplies;
+                case '%': return opcode::modulus;
+                case '+': return opcode::plus;
+                case '-': return opcode::minus;
+                case '>': return opcode::greater;
+                case '<': return opcode::less;
+                case GTE: return opcode::greater_equal;
+                case LTE: return opcode::less_equal;
+                case EQ: return opcode::equal_to;
+                case NEQ: return opcode::not_equal_to;
+                case AND: return opcode::logical_and;
+                case OR: return opcode::logical_or;
                 default: throw std::logic_error("Unexpected binary operator"); // LCOV_EXCL_LINE
             }
-#undef BINOP_CASE
         }
 
         template<size_t size>
@@ -197,70 +144,78 @@ namespace boost { namespace locale { namespace gnu_gettext { namespace lambda {
 
         class parser {
         public:
-            parser(const char* str) : t(str) {}
+            parser(const char* str) : t(str), stack_size_(0), max_stack_size_(0) {}
 
-            expr_ptr compile()
+            plural_expr compile()
             {
-                expr_ptr res = cond_expr();
-                if(res && t.next() != END)
-                    return expr_ptr();
-                return res;
+                if(!cond_expr() || t.next() != END)
+                    return plural_expr();
+                BOOST_ASSERT(stack_size_ == 1);
+                return plural_expr(std::move(code_), max_stack_size_);
             }
 
         private:
-            expr_ptr value_expr()
+            /// Add an instruction changing the number of values on the stack by \a stack_change
+            size_t emit(const opcode op, const int stack_change, const value_type value = 0)
+            {
+                code_.push_back(plural_expr::instruction{op, value});
+                stack_size_ += stack_change;
+                max_stack_size_ = std::max(max_stack_size_, stack_size_);
+                return code_.size() - 1;
+            }
+            /// Set the target of the jump instruction at \a pos to the next instruction
+            void set_jump_target(const size_t pos) { code_[pos].value = static_cast<value_type>(code_.size()); }
+
+            bool value_expr()
             {
-                expr_ptr op;
                 if(t.next() == '(') {
                     t.get();
-                    if(!(op = cond_expr()))
-                        return expr_ptr();
-                    if(t.get() != ')')
-                        return expr_ptr();
-                    return op;
+                    if(!cond_expr())
+                        return false;
+                    return t.get() == ')';
                 } else if(t.next() == NUM) {
-                    expr::value_type value;
+                    value_type value;
                     t.get(&value);
-                    return make_expr<number>(value);
+                    emit(opcode::number, 1, value);
+                    return true;
                 } else if(t.next() == VARIABLE) {
                     t.get();
-                    return make_expr<identity>();
+                    emit(opcode::variable, 1);
+                    return true;
                 }
-                return expr_ptr();
+                return false;
             }
 
-            expr_ptr unary_expr()
+            bool unary_expr()
             {
                 constexpr token_t level_unary[] = {'!', '-'};
                 if(is_in(t.next(), level_unary)) {
                     const token_t op = t.get();
-                    expr_ptr op1 = unary_expr();
-                    if(!op1)
-                        return expr_ptr();
+                    if(!unary_expr())
+                        return false;
                     if(BOOST_LIKELY(op == '!'))
-                        return make_expr<unary<std::logical_not<expr::value_type>>>(std::move(op1));
+                        emit(opcode::logical_not, 0);
                     else {
                         BOOST_ASSERT(op == '-');
-                        return make_expr<unary<std::negate<expr::value_type>>>(std::move(op1));
+                        emit(opcode::negate, 0);
                     }
+                    return true;
                 } else
                     return value_expr();
             }
 
-#define BINARY_EXPR(lvl, nextLvl, list)                           \
-    expr_ptr lvl()                                                \
-    {                                                             \
-        expr_ptr op1 = nextLvl();                                 \
-        if(!op1)                                                  \
-            return expr_ptr();                                    \
-        while(is_in(t.next(), list)) {                            \
-            const token_t o = t.get();                            \
-            expr_ptr op2 = nextLvl();                             \
-            if(!op2)                                              \
-                return expr_ptr();                                \
-            op1 = bin_factory(o, std::move(op1), std::move(op2)); \
-        }                                                         \
-        return op1;                                               \
+#define BINARY_EXPR(lvl, nextLvl, list) \
+    bool lvl()                          \
+    {                                   \
+        if(!nextLvl())                  \
+            return false;               \
+        while(is_in(t.next(), list)) {  \
+            const token_t o = t.get();  \
+            if(!nextLvl())              \
+                return false;           \
+            emit(binary_opcode(o), -1); \
+        }                               \
+        return true;                    \
     }
 
             BINARY_EXPR(l6, unary_expr, level6);
@@ -271,33 +226,84 @@ namespace boost { namespace locale { namespace gnu_gettext { namespace lambda {
             BINARY_EXPR(l1, l2, level1);
 #undef BINARY_EXPR
 
-            expr_ptr cond_expr()
+            bool cond_expr()
             {
-                expr_ptr cond;
-                if(!(cond = l1()))
-                    return expr_ptr();
+                if(!l1())
+                    return false;
                 if(t.next() != '?')
-                    return cond;
+                    return true;
                 t.get();
-                expr_ptr case1, case2;
-                if(!(case1 = cond_expr()))
-                    return expr_ptr();
+                // Only the selected case is evaluated
+                const size_t jump_to_case2 = emit(opcode::jump_if_zero, -1);
+                if(!cond_expr())
+                    return false;
                 if(t.get() != ':')
-                    return expr_ptr();
-                if(!(case2 = cond_expr()))
-                    return expr_ptr();
-                return make_expr<conditional>(std::move(cond), std::move(case1), std::move(case2));
+                    return false;
+                const size_t jump_to_end = emit(opcode::jump, -1); // Result of either case is on the stack
+                set_jump_target(jump_to_case2);
+                if(!cond_expr())
+                    return false;
+                set_jump_target(jump_to_end);
+                return true;
             }
 
             tokenizer t;
+            std::vector<plural_expr::instruction> code_;
+            size_t stack_size_;
+            size_t max_stack_size_;
         };
 
     } // namespace
 
+    plural_expr::value_type plural_expr::operator()(const value_type n) const
+    {
+        // Usually only a few values are required so avoid a heap allocation
+        value_type local_stack[16];
+        std::unique_ptr<value_type[]> heap_stack;
+        value_type* stack = local_stack;
+        if(stack_size_ > sizeof(local_stack) / sizeof(local_stack[0])) {
+            heap_stack.reset(new value_type[stack_size_]);
+            stack = heap_stack.get();
+        }
+        value_type* top = stack - 1; // Points to the last pushed value
+
+        const instruction* const begin = code_.data();
+        const instruction* const end = begin + code_.size();
+        for(const instruction* ip = begin; ip != end; ++ip) {
+            switch(ip->op) {
+                case opcode::number: *++top = ip->value; break;
+                case opcode::variable: *++top = n; break;
+                case opcode::negate: *top = -*top; break;
+                case opcode::logical_not: *top = !*top; break;
+                case opcode::multiplies: --top; *top = apply<std::multiplies<value_type>>(top); break;
+                // Special cases: Avoid division by zero
+                case opcode::divides: --top; *top = (top[1] == 0) ? 0 : apply<std::divides<value_type>>(top); break;
+                case opcode::modulus: --top; *top = (top[1] == 0) ? 0 : apply<std::modulus<value_type>>(top); break;
+                case opcode::plus: --top; *top = apply<std::plus<value_type>>(top); break;
+                case opcode::minus: --top; *top = apply<std::minus<value_type>>(top); break;
+                case opcode::greater: --top; *top = apply<std::greater<value_type>>(top); break;
+                case opcode::less: --top; *top = apply<std::less<value_type>>(top); break;
+                case opcode::greater_equal: --top; *top = apply<std::greater_equal<value_type>>(top); break;
+                case opcode::less_equal: --top; *top = apply<std::less_equal<value_type>>(top); break;
+                case opcode::equal_to: --top; *top = apply<std::equal_to<value_type>>(top); break;
+                case opcode::not_equal_to: --top; *top = apply<std::not_equal_to<value_type>>(top); break;
+                case opcode::logical_and: --top; *top = apply<std::logical_and<value_type>>(top); break;
+                case opcode::logical_or: --top; *top = apply<std::logical_or<value_type>>(top); break;
+                case opcode::jump_if_zero:
+                    if(*top-- != 0)
+                        break;
+                    BOOST_FALLTHROUGH;
+                case opcode::jump: ip = begin + ip->value - 1; break;
+            }
+        }
+        BOOST_ASSERT(top == stack);
+        return *top;
+    }
+
     plural_expr compile(const char* str)
     {
         parser p(str);
-        return plural_expr(p.compile());
+        return p.compile();
     }
 
 }}}} // namespace boost::locale::gnu_gettext::lambda
@@ -9,25 +9,56 @@
 #define BOOST_SRC_LOCALE_MO_LAMBDA_HPP_INCLUDED
 
 #include <boost/locale/config.hpp>
-#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace boost { namespace locale { namespace gnu_gettext { namespace lambda {
 
-    struct BOOST_SYMBOL_VISIBLE expr {
+    /// Plural form expression compiled to a flat program for a stack machine
+    class plural_expr {
+    public:
         using value_type = long long;
-        virtual value_type operator()(value_type n) const = 0;
-        virtual ~expr() = default;
-    };
-    using expr_ptr = std::unique_ptr<expr>;
 
-    class plural_expr {
-        expr_ptr p_;
+        enum class opcode : uint8_t {
+            number,   ///< Push the value
+            variable, ///< Push n
+            // Unary operators replacing the top of the stack
+            negate,
+            logical_not,
+            // Binary operators replacing the 2 top values of the stack
+            multiplies,
+            divides,
+            modulus,
+            plus,
+            minus,
+            greater,
+            less,
+            greater_equal,
+            less_equal,
+            equal_to,
+            not_equal_to,
+            logical_and,
+            logical_or,
+            // Jumps to the instruction at index `value`
+            jump_if_zero, ///< Pop the top of the stack and jump if it is zero
+            jump,
+        };
+        struct instruction {
+            opcode op;
+            value_type value;
+        };
 
-    public:
-        plural_expr() = default;
-        explicit plural_expr(expr_ptr p) : p_(std::move(p)) {}
-        expr::value_type operator()(expr::value_type n) const { return (*p_)(n); }
-        explicit operator bool() const { return static_cast<bool>(p_); }
+        plural_expr() : stack_size_(0) {}
+        plural_expr(std::vector<instruction> code, size_t stack_size) :
+            code_(std::move(code)), stack_size_(stack_size)
+        {}
+        BOOST_LOCALE_DECL value_type operator()(value_type n) const;
+        explicit operator bool() const { return !code_.empty(); }
+
+    private:
+        std::vector<instruction> code_;
+        size_t stack_size_; ///< Maximum number of values on the stack during evaluation
     };
 
     BOOST_LOCALE_DECL plural_expr compile(const char* c_expression);
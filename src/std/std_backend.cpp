@@ -23,6 +23,7 @@
 #    include "../win32/lcid.hpp"
 #    include <windows.h>
 #endif
+#include "../shared/facet_table.hpp"
 #include "../shared/message.hpp"
 #include "../util/encoding.hpp"
 #include "../util/gregorian.hpp"
@@ -76,10 +77,10 @@ namespace boost { namespace locale { namespace impl_std {
 
     class std_localization_backend : public localization_backend {
     public:
-        std_localization_backend() : invalid_(true), use_ansi_encoding_(false) {}
+        std_localization_backend() : invalid_(true), use_ansi_encoding_(false), share_facets_(false) {}
         std_localization_backend(const std_localization_backend& other) :
-            localization_backend(), paths_(other.paths_), domains_(other.domains_), locale_id_(other.locale_id_),
-            invalid_(true), use_ansi_encoding_(other.use_ansi_encoding_)
+            localization_backend(), messages_(other.messages_), locale_id_(other.locale_id_),
+            invalid_(true), use_ansi_encoding_(other.use_ansi_encoding_), share_facets_(other.share_facets_)
         {}
         std_localization_backend* clone() const override { return new std_localization_backend(*this); }
 
@@ -88,20 +89,20 @@ namespace boost { namespace locale { namespace impl_std {
             invalid_ = true;
             if(name == "locale")
                 locale_id_ = value;
-            else if(name == "message_path")
-                paths_.push_back(value);
-            else if(name == "message_application")
-                domains_.push_back(value);
             else if(name == "use_ansi_encoding")
                 use_ansi_encoding_ = value == "true";
+            else if(name == "share_facets")
+                share_facets_ = value == "true";
+            else
+                messages_.set_option(name, value);
         }
         void clear_options() override
         {
             invalid_ = true;
             use_ansi_encoding_ = false;
+            share_facets_ = false;
             locale_id_.clear();
-            paths_.clear();
-            domains_.clear();
+            messages_.clear();
         }
 
         void prepare_data()
@@ -175,7 +176,15 @@ namespace boost { namespace locale { namespace impl_std {
         std::locale install(const std::locale& base, category_t category, char_facet_t type) override
         {
             prepare_data();
+            if(!share_facets_)
+                return install_facets(base, category, type);
+            const auto create_facets = [&](const std::locale& in) { return install_facets(in, category, type); };
+            return detail::install_shared_facets(base, "std\n" + in_use_id_, category, type, create_facets);
+        }
 
+    private:
+        std::locale install_facets(const std::locale& base, category_t category, char_facet_t type)
+        {
             switch(category) {
                 case category_t::convert: return create_convert(base, name_, type, utf_mode_);
                 case category_t::collation: return create_collate(base, name_, type, utf_mode_);
@@ -183,16 +192,14 @@ namespace boost { namespace locale { namespace impl_std {
                 case category_t::parsing: return create_parsing(base, name_, type, utf_mode_);
                 case category_t::codepage: return create_codecvt(base, name_, type, utf_mode_);
                 case category_t::calendar: return util::install_gregorian_calendar(base, data_.country());
-                case category_t::message: return detail::install_message_facet(base, type, data_, domains_, paths_);
+                case category_t::message: return detail::install_message_facet(base, type, data_, messages_);
                 case category_t::information: return util::create_info(base, in_use_id_);
                 case category_t::boundary: break; // Not implemented
             }
             return base;
         }
 
-    private:
-        std::vector<std::string> paths_;
-        std::vector<std::string> domains_;
+        detail::message_options messages_;
         std::string locale_id_;
 
         util::locale_data data_;
@@ -201,6 +208,7 @@ namespace boost { namespace locale { namespace impl_std {
         utf8_support utf_mode_;
         bool invalid_;
         bool use_ansi_encoding_;
+        bool share_facets_;
     };
 
     std::unique_ptr<localization_backend> create_localization_backend()
@@ -11,6 +11,7 @@
 #include <boost/locale/localization_backend.hpp>
 #include <boost/locale/util.hpp>
 #include <boost/locale/util/locale_data.hpp>
+#include "../shared/facet_table.hpp"
 #include "../shared/message.hpp"
 #include "../util/gregorian.hpp"
 #include "../util/make_std_unique.hpp"
@@ -24,10 +25,10 @@ namespace boost { namespace locale { namespace impl_win {
 
     class winapi_localization_backend : public localization_backend {
     public:
-        winapi_localization_backend() : invalid_(true) {}
+        winapi_localization_backend() : invalid_(true), share_facets_(false) {}
         winapi_localization_backend(const winapi_localization_backend& other) :
-            localization_backend(), paths_(other.paths_), domains_(other.domains_), locale_id_(other.locale_id_),
-            invalid_(true)
+            localization_backend(), messages_(other.messages_), locale_id_(other.locale_id_),
+            invalid_(true), share_facets_(other.share_facets_)
         {}
         winapi_localization_backend* clone() const override { return new winapi_localization_backend(*this); }
 
@@ -36,17 +37,17 @@ namespace boost { namespace locale { namespace impl_win {
             invalid_ = true;
             if(name == "locale")
                 locale_id_ = value;
-            else if(name == "message_path")
-                paths_.push_back(value);
-            else if(name == "message_application")
-                domains_.push_back(value);
+            else if(name == "share_facets")
+                share_facets_ = value == "true";
+            else
+                messages_.set_option(name, value);
         }
         void clear_options() override
         {
             invalid_ = true;
+            share_facets_ = false;
             locale_id_.clear();
-            paths_.clear();
-            domains_.clear();
+            messages_.clear();
         }
 
         void prepare_data()
@@ -68,7 +69,15 @@ namespace boost { namespace locale { namespace impl_win {
         std::locale install(const std::locale& base, category_t category, char_facet_t type) override
         {
             prepare_data();
+            if(!share_facets_)
+                return install_facets(base, category, type);
+            const auto create_facets = [&](const std::locale& in) { return install_facets(in, category, type); };
+            return detail::install_shared_facets(base, "winapi\n" + real_id_, category, type, create_facets);
+        }
 
+    private:
+        std::locale install_facets(const std::locale& base, category_t category, char_facet_t type)
+        {
             switch(category) {
                 case category_t::convert: return create_convert(base, lc_, type);
                 case category_t::collation: return create_collate(base, lc_, type);
@@ -79,7 +88,7 @@ namespace boost { namespace locale { namespace impl_win {
                     inf.parse(real_id_);
                     return util::install_gregorian_calendar(base, inf.country());
                 }
-                case category_t::message: return detail::install_message_facet(base, type, data_, domains_, paths_);
+                case category_t::message: return detail::install_message_facet(base, type, data_, messages_);
                 case category_t::information: return util::create_info(base, real_id_);
                 case category_t::codepage: return util::create_utf8_codecvt(base, type);
                 case category_t::boundary: break; // Not implemented
@@ -87,15 +96,14 @@ namespace boost { namespace locale { namespace impl_win {
             return base;
         }
 
-    private:
-        std::vector<std::string> paths_;
-        std::vector<std::string> domains_;
+        detail::message_options messages_;
         std::string locale_id_;
         std::string real_id_;
         util::locale_data data_;
 
         bool invalid_;
         winlocale lc_;
+        bool share_facets_;
     };
 
     std::unique_ptr<localization_backend> create_localization_backend()
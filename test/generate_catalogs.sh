@@ -10,3 +10,4 @@ msgfmt he/LC_MESSAGES/default.po -o he/LC_MESSAGES/default.mo
 msgfmt he/LC_MESSAGES/fall.po -o he/LC_MESSAGES/fall.mo
 msgfmt he_IL/LC_MESSAGES/full.po -o he_IL/LC_MESSAGES/full.mo
 
+msgfmt --no-hash he/LC_MESSAGES/default.po -o he/LC_MESSAGES/default_nohash.mo
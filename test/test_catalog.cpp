@@ -10,6 +10,7 @@
 #include <iostream>
 #include <limits>
 #include <random>
+#include <string>
 
 template<typename T>
 T getRandValue(const T min, const T max)
@@ -286,6 +287,25 @@ void test_plural_expr()
         TEST_EQ(p(minVal), 2);
         TEST_EQ(p(maxVal), 2);
     }
+    // Deeply nested expressions requiring a large evaluation stack
+    {
+        std::string expr = "n";
+        std::string cond_expr = "n";
+        for(int i = 0; i < 40; i++) {
+            expr = "1 + (" + expr + ")";
+            cond_expr = "n == " + std::to_string(i) + " ? " + std::to_string(i * 2) + " : (" + cond_expr + ")";
+        }
+        const auto p = compile(expr.c_str());
+        TEST_REQUIRE(p);
+        TEST_EQ(p(0), 40);
+        TEST_EQ(p(-40), 0);
+        const auto p2 = compile(cond_expr.c_str());
+        TEST_REQUIRE(p2);
+        for(int i = 0; i < 40; i++)
+            TEST_EQ(p2(i), i * 2);
+        TEST_EQ(p2(40), 40);
+        TEST_EQ(p2(-1), -1);
+    }
 #undef COMPILE_PLURAL_EXPR
     // Error cases
     TEST(!compile("") && compile("n")); // Empty
@@ -123,6 +123,9 @@ void test_to_utf_for_impls(const std::string& source,
     if(test_default) {
         boost::locale::conv::utf_encoder<Char> conv(encoding);
         TEST_EQ(conv(source), target);
+        std::basic_string<Char> out = ascii_to<Char>("prefix");
+        TEST_EQ(conv.convert(source, out), target.size());
+        TEST_EQ(out, ascii_to<Char>("prefix") + target);
     }
     for(const auto impl : all_conv_backends) {
         std::cout << "----- Convert to UTF w/ " << impl << '\n';
@@ -131,6 +134,9 @@ void test_to_utf_for_impls(const std::string& source,
             auto convPtr =
               boost::locale::conv::detail::make_utf_encoder<Char>(encoding, boost::locale::conv::skip, impl);
             TEST_EQ(convPtr->convert(source), target);
+            std::basic_string<Char> out = ascii_to<Char>("prefix");
+            TEST_EQ(convPtr->convert(source.data(), source.data() + source.size(), out), target.size());
+            TEST_EQ(out, ascii_to<Char>("prefix") + target);
         } catch(invalid_charset_error&) {
             std::cout << "--- Charset not supported\n"; // LCOV_EXCL_LINE
             continue;                                   // LCOV_EXCL_LINE
@@ -139,15 +145,26 @@ void test_to_utf_for_impls(const std::string& source,
             auto convPtr =
               boost::locale::conv::detail::make_utf_encoder<Char>(encoding, boost::locale::conv::stop, impl);
             TEST_FAIL_CONVERSION(convPtr->convert(source));
+            std::basic_string<Char> out = ascii_to<Char>("prefix");
+            TEST_FAIL_CONVERSION(convPtr->convert(source.data(), source.data() + source.size(), out));
+            TEST_EQ(out, ascii_to<Char>("prefix"));
         }
     }
     if(encoding == "UTF-8") {
         using boost::locale::conv::utf_to_utf;
         TEST_EQ(utf_to_utf<Char>(source), target);
+        std::basic_string<Char> out = ascii_to<Char>("prefix");
+        TEST_EQ(utf_to_utf(source.data(), source.data() + source.size(), out), target.size());
+        TEST_EQ(out, ascii_to<Char>("prefix") + target);
         if(expectSuccess)
             TEST_EQ(utf_to_utf<char>(source), source);
-        else
+        else {
             TEST_FAIL_CONVERSION(utf_to_utf<Char>(source, boost::locale::conv::stop));
+            out = ascii_to<Char>("prefix");
+            TEST_FAIL_CONVERSION(
+              utf_to_utf(source.data(), source.data() + source.size(), out, boost::locale::conv::stop));
+            TEST_EQ(out, ascii_to<Char>("prefix"));
+        }
     }
 }
 
@@ -162,6 +179,9 @@ void test_from_utf_for_impls(const std::basic_string<Char>& source,
     if(test_default) {
         boost::locale::conv::utf_decoder<Char> conv(encoding);
         TEST_EQ(conv(source), target);
+        std::string out = "prefix";
+        TEST_EQ(conv.convert(source, out), target.size());
+        TEST_EQ(out, "prefix" + target);
     }
     for(const auto impl : all_conv_backends) {
         std::cout << "----- Convert from UTF w/ " << impl << '\n';
@@ -170,6 +190,9 @@ void test_from_utf_for_impls(const std::basic_string<Char>& source,
             auto convPtr =
               boost::locale::conv::detail::make_utf_decoder<Char>(encoding, boost::locale::conv::skip, impl);
             TEST_EQ(convPtr->convert(source), target);
+            std::string out = "prefix";
+            TEST_EQ(convPtr->convert(source.data(), source.data() + source.size(), out), target.size());
+            TEST_EQ(out, "prefix" + target);
         } catch(invalid_charset_error&) {
             std::cout << "--- Charset not supported\n"; // LCOV_EXCL_LINE
             continue;                                   // LCOV_EXCL_LINE
@@ -178,6 +201,9 @@ void test_from_utf_for_impls(const std::basic_string<Char>& source,
             auto convPtr =
               boost::locale::conv::detail::make_utf_decoder<Char>(encoding, boost::locale::conv::stop, impl);
             TEST_FAIL_CONVERSION(convPtr->convert(source));
+            std::string out = "prefix";
+            TEST_FAIL_CONVERSION(convPtr->convert(source.data(), source.data() + source.size(), out));
+            TEST_EQ(out, "prefix");
         }
     }
     if(encoding == "UTF-8") {
@@ -407,6 +433,16 @@ void test_utf_for()
     } catch(const invalid_charset_error&) { // LCOV_EXCL_LINE
         std::cout << "--- not supported\n"; // LCOV_EXCL_LINE
     }
+    // Converters are reused, so an aborted conversion must not leave a shift state behind
+    try {
+        using boost::locale::conv::from_utf;
+        using boost::locale::conv::conversion_error;
+        const std::basic_string<Char> text = utf<Char>("冬季€");
+        TEST_THROWS(from_utf<Char>(text, "iso-2022-jp", boost::locale::conv::stop), conversion_error);
+        TEST_EQ(from_utf<Char>(ascii_to<Char>("abc"), "iso-2022-jp", boost::locale::conv::stop), "abc");
+    } catch(const invalid_charset_error&) { // LCOV_EXCL_LINE
+        std::cout << "--- not supported\n"; // LCOV_EXCL_LINE
+    }
     const auto iconvIssue = isFaultyIconv();
     // Testing a codepage which may crash with IConv on macOS, see issue #196
     if(iconvIssue != MacOSIconvIssue::InfiniteLoop)
@@ -417,6 +453,24 @@ void test_utf_for()
     if(iconvIssue != MacOSIconvIssue::No_CN_Support)
         test_to_from_utf<Char>("\x1b\x24\x29\x41\x0e\x4a\x35\xf", utf<Char>("实"), "ISO-2022-CN", false);
 
+    std::cout << "- Testing long texts for " << char_name<Char>() << '\n';
+    {
+        // Much longer than a single chunk of the converters and changing its size when converted
+        std::string latin1, iso2022jp, utf8_latin1, utf8_jp;
+        for(int i = 0; i < 1000; i++) {
+            latin1 += to<char>("grüßen");
+            utf8_latin1 += "grüßen";
+            iso2022jp += "\x1b$BE_5(\x1b(Ba";
+            utf8_jp += "冬季a";
+        }
+        test_to_from_utf<Char>(latin1, utf<Char>(utf8_latin1), "ISO8859-1");
+        try {
+            test_to_from_utf<Char>(iso2022jp, utf<Char>(utf8_jp), "iso-2022-jp");
+        } catch(const invalid_charset_error&) { // LCOV_EXCL_LINE
+            std::cout << "--- not supported\n"; // LCOV_EXCL_LINE
+        }
+    }
+
     std::cout << "- Testing correct invalid bytes skipping for " << char_name<Char>() << '\n';
     {
         std::cout << "-- UTF-8" << std::endl;
@@ -497,6 +551,14 @@ void test_utf_to_utf_for(const std::string& utf8_string)
     TEST_EQ(utf_to_utf<Char2>(utf_string1), utf_string2);
     TEST_EQ(utf_to_utf<Char1>(utf_string1), utf_string1);
     TEST_EQ(utf_to_utf<Char2>(utf_string2), utf_string2);
+    // ASCII runs of different lengths around other characters
+    for(size_t n = 0; n < 40; n++) {
+        TEST_CONTEXT("ASCII run of " << n);
+        const std::string ascii(n, 'x');
+        const std::string text = ascii + utf8_string + ascii + "\xf0\xa0\x82\x8a" + ascii;
+        TEST_EQ(utf_to_utf<Char1>(utf<Char2>(text)), utf<Char1>(text));
+        TEST_EQ(utf_to_utf<Char2>(utf<Char1>(text)), utf<Char2>(text));
+    }
 }
 
 template<typename Char>
@@ -504,6 +566,27 @@ void test_utf_to_utf_for()
 {
     const std::string& utf8_string = "A-Za-z0-9grüße'\xf0\xa0\x82\x8a'\xf4\x8f\xbf\xbf";
     test_utf_to_utf_for<Char, char>(utf8_string);
+    // Invalid and incomplete sequences after ASCII runs
+    for(size_t n = 0; n < 40; n += 3) {
+        TEST_CONTEXT("ASCII run of " << n);
+        using boost::locale::conv::utf_to_utf;
+        const std::string ascii(n, 'x');
+        TEST_EQ(utf_to_utf<Char>(ascii + "\xFF" + ascii + "ü"), utf<Char>(ascii + ascii + "ü"));
+        TEST_FAIL_CONVERSION(utf_to_utf<Char>(ascii + "\xFF" + ascii, boost::locale::conv::stop));
+        TEST_EQ(utf_to_utf<Char>(ascii + "ü" + ascii + "\xe2\x82"), utf<Char>(ascii + "ü" + ascii));
+        TEST_FAIL_CONVERSION(utf_to_utf<Char>(ascii + "\xe2\x82", boost::locale::conv::stop));
+    }
+    // The character after an invalid sequence is skipped with it anywhere in long texts
+    for(size_t n = 0; n < 80; n++) {
+        TEST_CONTEXT("Invalid sequence after " << n << " characters");
+        using boost::locale::conv::utf_to_utf;
+        std::string head, tail;
+        for(size_t i = 0; i < n; i++)
+            head += "ü";
+        for(size_t i = 0; i < 40; i++)
+            tail += "ü";
+        TEST_EQ(utf_to_utf<Char>(head + "\xe2\x82x" + tail + "abc"), utf<Char>(head + tail + "abc"));
+    }
     test_to_utf_for_impls(utf8_string, utf<Char>(utf8_string), "UTF-8");
     test_from_utf_for_impls(utf<Char>(utf8_string), utf8_string, "UTF-8");
     test_utf_to_utf_for<Char, wchar_t>(utf8_string);
@@ -744,6 +827,9 @@ void test_between_for_impls(const std::string& source,
 {
     boost::locale::conv::narrow_converter conv(from_encoding, to_encoding);
     TEST_EQ(conv(source), target);
+    std::string out = "prefix";
+    TEST_EQ(conv.convert(source, out), target.size());
+    TEST_EQ(out, "prefix" + target);
     for(const auto impl : all_conv_backends) {
         using boost::locale::conv::detail::make_narrow_converter;
         std::cout << "----- " << impl << '\n';
@@ -757,6 +843,9 @@ void test_between_for_impls(const std::string& source,
         if(!expectSuccess) {
             auto convPtr = make_narrow_converter(from_encoding, to_encoding, boost::locale::conv::stop, impl);
             TEST_FAIL_CONVERSION(convPtr->convert(source));
+            out = "prefix";
+            TEST_FAIL_CONVERSION(convPtr->convert(source.data(), source.data() + source.size(), out));
+            TEST_EQ(out, "prefix");
         }
     }
     if(to_encoding == "UTF-8" && from_encoding == "UTF-8") {
@@ -835,6 +924,145 @@ void test_between()
     test_error_between("f\xFF\xFF\xFFoo7", "foo7", "UTF-8", "UTF-8");
 }
 
+template<typename CharIn, typename CharOut>
+void test_stream_conversion(const std::basic_string<CharIn>& source,
+                            const std::basic_string<CharOut>& target,
+                            const std::string& src_encoding,
+                            const std::string& target_encoding)
+{
+    TEST_CONTEXT(src_encoding << '/' << char_name<CharIn>() << "->" << target_encoding << '/' << char_name<CharOut>());
+    std::cout << "-- " << src_encoding << "->" << target_encoding << std::endl;
+    using boost::locale::conv::invalid_charset_error;
+    for(const auto impl : all_conv_backends) {
+        std::cout << "----- " << impl << '\n';
+        std::unique_ptr<boost::locale::conv::detail::stream_converter<CharIn, CharOut>> cvt;
+        try {
+            using boost::locale::conv::detail::make_stream_converter;
+            using boost::locale::conv::stop;
+            cvt = make_stream_converter<CharIn, CharOut>(src_encoding, target_encoding, stop, impl);
+        } catch(const invalid_charset_error&) {
+            std::cout << "--- not supported\n";
+            continue;
+        }
+        // Any split into 2 chunks
+        for(size_t i = 0; i <= source.size(); i++) {
+            TEST_CONTEXT("Split at " << i);
+            std::basic_string<CharOut> out;
+            cvt->convert(source.data(), source.data() + i, out, false);
+            cvt->convert(source.data() + i, source.data() + source.size(), out, false);
+            cvt->convert(nullptr, nullptr, out, true);
+            TEST_EQ(out, target);
+        }
+        // Any split into 3 chunks, so a chunk may complete a character and end with an incomplete one
+        for(size_t i = 0; i <= source.size(); i++) {
+            for(size_t j = i; j <= source.size(); j++) {
+                TEST_CONTEXT("Split at " << i << " and " << j);
+                std::basic_string<CharOut> out;
+                cvt->convert(source.data(), source.data() + i, out, false);
+                cvt->convert(source.data() + i, source.data() + j, out, false);
+                cvt->convert(source.data() + j, source.data() + source.size(), out, true);
+                TEST_EQ(out, target);
+            }
+        }
+        // One code unit at a time
+        std::basic_string<CharOut> out;
+        for(const CharIn c : source)
+            cvt->convert(&c, &c + 1, out, false);
+        cvt->convert(nullptr, nullptr, out, true);
+        TEST_EQ(out, target);
+    }
+    boost::locale::conv::stream_converter<CharIn, CharOut> cvt(src_encoding, target_encoding);
+    const size_t half = source.size() / 2;
+    std::basic_string<CharOut> out = cvt.convert(source.substr(0, half));
+    const size_t first_size = out.size();
+    const size_t appended = cvt.convert(source.substr(half), out);
+    TEST_EQ(first_size + appended, out.size());
+    TEST_EQ(out + cvt.finish(), target);
+}
+
+template<typename Char>
+void test_stream_converter_for()
+{
+    std::cout << "- Testing stream converter for " << char_name<Char>() << '\n';
+    using boost::locale::conv::invalid_charset_error;
+    using boost::locale::conv::stream_converter;
+
+    test_stream_conversion<char, Char>(to<char>("grüßen"), utf<Char>("grüßen"), "ISO-8859-1", "UTF-8");
+    test_stream_conversion<Char, char>(utf<Char>("grüßen"), to<char>("grüßen"), "UTF-8", "ISO-8859-1");
+    // Multi-byte sequences and surrogate pairs which might get split
+    const std::string utf8 = "a€\xf0\x9d\x84\x9e"
+                             "b";
+    test_stream_conversion<char, Char>(utf8, utf<Char>(utf8), "UTF-8", "UTF-8");
+    test_stream_conversion<Char, char>(utf<Char>(utf8), utf8, "UTF-8", "UTF-8");
+    // Stateful encodings
+    try {
+        const std::string iso2022jp = "\x1b$BE_5(\x1b(Ba\x1b$BE_5(\x1b(B";
+        test_stream_conversion<char, Char>(iso2022jp, utf<Char>("冬季a冬季"), "ISO-2022-JP", "UTF-8");
+        test_stream_conversion<Char, char>(utf<Char>("冬季a冬季"), iso2022jp, "UTF-8", "ISO-2022-JP");
+    } catch(const invalid_charset_error&) { // LCOV_EXCL_LINE
+        std::cout << "--- not supported\n"; // LCOV_EXCL_LINE
+    }
+    try {
+        test_stream_conversion<char, Char>("Hi Mom -+Jjo--!", utf<Char>("Hi Mom -☺-!"), "UTF-7", "UTF-8");
+    } catch(const invalid_charset_error&) { // LCOV_EXCL_LINE
+        std::cout << "--- not supported\n"; // LCOV_EXCL_LINE
+    }
+
+    std::cout << "-- Incomplete sequence at the end" << std::endl;
+    const std::string incomplete = "a\xe2\x82";
+    for(const auto impl : all_conv_backends) {
+        std::cout << "----- " << impl << '\n';
+        using boost::locale::conv::detail::make_stream_converter;
+        for(const auto how : {boost::locale::conv::skip, boost::locale::conv::stop}) {
+            std::unique_ptr<boost::locale::conv::detail::stream_converter<char, Char>> cvt;
+            try {
+                cvt = make_stream_converter<char, Char>("UTF-8", "UTF-8", how, impl);
+            } catch(const invalid_charset_error&) {
+                continue;
+            }
+            std::basic_string<Char> out;
+            TEST_EQ(cvt->convert(incomplete.data(), incomplete.data() + incomplete.size(), out, false), 1u);
+            if(how == boost::locale::conv::stop)
+                TEST_FAIL_CONVERSION(cvt->convert(nullptr, nullptr, out, true));
+            else
+                cvt->convert(nullptr, nullptr, out, true);
+            TEST_EQ(out, ascii_to<Char>("a"));
+        }
+    }
+    {
+        stream_converter<char, Char> cvt("UTF-8", "UTF-8", boost::locale::conv::stop);
+        TEST_EQ(cvt.convert(incomplete), ascii_to<Char>("a"));
+        TEST_FAIL_CONVERSION(cvt.finish());
+        // Converter was reset
+        TEST_EQ(cvt.convert("b"), ascii_to<Char>("b"));
+        TEST_EQ(cvt.finish(), ascii_to<Char>(""));
+        // Skipped by default
+        stream_converter<char, Char> skipping_cvt("UTF-8");
+        TEST_EQ(skipping_cvt.convert(incomplete) + skipping_cvt.finish(), ascii_to<Char>("a"));
+        // Explicitly started new text discards the incomplete sequence
+        TEST_EQ(cvt.convert(incomplete), ascii_to<Char>("a"));
+        cvt.reset();
+        TEST_EQ(cvt.convert("b") + cvt.finish(), ascii_to<Char>("b"));
+    }
+    TEST_THROWS((stream_converter<char, Char>("Invalid-Encoding")), invalid_charset_error);
+}
+
+void test_stream_converter()
+{
+    std::cout << "Testing stream converter\n";
+    test_stream_converter_for<char>();
+    test_stream_converter_for<wchar_t>();
+#ifdef __cpp_lib_char8_t
+    test_stream_converter_for<char8_t>();
+#endif
+#ifdef BOOST_LOCALE_ENABLE_CHAR16_T
+    test_stream_converter_for<char16_t>();
+#endif
+#ifdef BOOST_LOCALE_ENABLE_CHAR32_T
+    test_stream_converter_for<char32_t>();
+#endif
+}
+
 void test_utf_name();
 void test_simple_encodings();
 void test_win_codepages();
@@ -870,6 +1098,7 @@ void test_main(int /*argc*/, char** /*argv*/)
 
     test_all_combinations();
     test_between();
+    test_stream_converter();
 }
 
 // Internal tests, keep those out of the above scope
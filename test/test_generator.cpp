@@ -12,11 +12,18 @@
 #include "boostLocale/test/unit_test.hpp"
 #include <boost/assert.hpp>
 #include <boost/core/ignore_unused.hpp>
+#include <boost/thread/thread.hpp>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iomanip>
 #include <locale>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #ifdef BOOST_LOCALE_WITH_ICU
 #    include <unicode/uversion.h>
@@ -67,6 +74,22 @@ struct test_facet : public std::locale::facet {
 
 std::locale::id test_facet::id;
 
+struct counting_observer : boost::locale::generation_observer {
+    std::atomic<int> hits{0}, misses{0}, installations{0}, icu_objects{0};
+    void cache_hit(const std::string&) override { ++hits; }
+    void cache_miss(const std::string&) override { ++misses; }
+    void category_installed(const std::string& id,
+                            boost::locale::category_t,
+                            boost::locale::char_facet_t,
+                            std::chrono::nanoseconds duration) override
+    {
+        TEST_EQ(id, "en_US.UTF-8");
+        TEST(duration.count() >= 0);
+        ++installations;
+    }
+    void icu_object_created(const char*) override { ++icu_objects; }
+};
+
 template<typename CharType>
 using codecvt_by_char_type = std::codecvt<CharType, char, std::mbstate_t>;
 
@@ -291,6 +314,86 @@ void test_std_collate_replaced(const std::string& /*backendName*/)
     }
 }
 
+/// Backend taking some time to install facets, which fails while \a failing is set
+class slow_backend : public bl::localization_backend {
+public:
+    slow_backend(const std::atomic<bool>& failing, std::atomic<int>& installations) :
+        failing_(&failing), installations_(&installations)
+    {}
+    slow_backend* clone() const override { return new slow_backend(*this); }
+    void set_option(const std::string&, const std::string&) override {}
+    void clear_options() override {}
+    std::locale install(const std::locale& base, bl::category_t, bl::char_facet_t) override
+    {
+        ++*installations_;
+        boost::this_thread::sleep_for(boost::chrono::milliseconds(20));
+        if(*failing_)
+            throw std::runtime_error("Installation failed");
+        return base;
+    }
+
+private:
+    const std::atomic<bool>* failing_;
+    std::atomic<int>* installations_;
+};
+
+void test_concurrent_generation()
+{
+    std::atomic<bool> failing{false};
+    std::atomic<int> installations{0};
+    bl::localization_backend_manager manager;
+    manager.add_backend("slow", std::unique_ptr<bl::localization_backend>(new slow_backend(failing, installations)));
+    bl::generator g(manager);
+    g.categories(bl::category_t::information);
+    g.characters(bl::char_facet_t::char_f);
+    g.locale_cache_enabled(true);
+
+    constexpr int num_threads = 8;
+    const auto run_threads = [](const std::function<void(int)>& f) {
+        std::vector<boost::thread> threads;
+        for(int i = 0; i < num_threads; ++i)
+            threads.emplace_back([&f, i]() { f(i); });
+        for(boost::thread& thread : threads)
+            thread.join();
+    };
+
+    // Each id is generated once no matter how many threads request it at the same time
+    std::atomic<int> num_errors{0};
+    run_threads([&](int i) {
+        try {
+            g("en_US.UTF-8");
+            g("de_DE.UTF-8");
+            g("xx_XX" + std::to_string(i) + ".UTF-8");
+        } catch(...) {
+            ++num_errors; // LCOV_EXCL_LINE
+        }
+    });
+    TEST_EQ(num_errors, 0);
+    TEST_EQ(installations, 2 + num_threads);
+    TEST_EQ(g.locale_cache_stats().misses, 2u + num_threads);
+    TEST_EQ(g.locale_cache_stats().hits, 2u * (num_threads - 1));
+
+    // A failed generation is reported to all threads waiting for it and nothing is cached
+    failing = true;
+    installations = 0;
+    run_threads([&](int) {
+        try {
+            g("fr_FR.UTF-8");
+        } catch(const std::runtime_error& e) {
+            TEST_EQ(std::string(e.what()), "Installation failed");
+            ++num_errors;
+        }
+    });
+    TEST_EQ(num_errors, num_threads);
+    TEST(installations >= 1);
+    TEST(installations < num_threads); // Some threads should have waited for another
+    // Later requests generate the locale anew
+    failing = false;
+    installations = 0;
+    run_threads([&](int) { g("fr_FR.UTF-8"); });
+    TEST_EQ(installations, 1);
+}
+
 void test_main(int /*argc*/, char** /*argv*/)
 {
     {
@@ -321,9 +424,11 @@ void test_main(int /*argc*/, char** /*argv*/)
         tmp_backend.select(backendName);
         bl::localization_backend_manager::global(tmp_backend);
         bl::generator g;
-        for(const std::string localeName : {"", "C", "en_US.UTF-8", "en_US.ISO8859-1", "tr_TR.windows1254"}) {
-            std::cout << "-- Locale: " << localeName << std::endl;
-            const std::locale l = g(localeName);
+        for(const bool share : {false, true}) {
+            g.share_facets(share);
+            for(const std::string localeName : {"", "C", "en_US.UTF-8", "en_US.ISO8859-1", "tr_TR.windows1254"}) {
+                std::cout << "-- Locale: " << localeName << std::endl;
+                const std::locale l = g(localeName);
 #ifdef __cpp_char8_t
 #    define TEST_FOR_CHAR8(check) TEST(check)
 #else
@@ -357,43 +462,45 @@ void test_main(int /*argc*/, char** /*argv*/)
         TEST_HAS_FACET_CHAR32(facet, l);         \
     } while(false)
 
-            // Convert
-            TEST_HAS_FACETS(bl::converter, l);
-            TEST_HAS_FACET_STRING8(bl::converter, l);
-            // Collator
-            TEST_HAS_FACETS(std::collate, l);
-            if(backendName == "icu" || (backendName == "winapi" && std::use_facet<bl::info>(l).utf8())) {
-                TEST_HAS_FACETS(bl::collator, l);
-                TEST_HAS_FACET_STRING8(bl::collator, l);
-            } else {
-                TEST(blt::has_not_facet<bl::collator<char>>(l));
-                TEST(blt::has_not_facet<bl::collator<wchar_t>>(l));
-                TEST_FOR_STRING8(blt::has_not_facet<bl::collator<char8_t>>(l));
-                TEST_FOR_CHAR16(blt::has_not_facet<bl::collator<char16_t>>(l));
-                TEST_FOR_CHAR32(blt::has_not_facet<bl::collator<char32_t>>(l));
+                // Convert
+                TEST_HAS_FACETS(bl::converter, l);
+                TEST_HAS_FACET_STRING8(bl::converter, l);
+                // Collator
+                TEST_HAS_FACETS(std::collate, l);
+                if(backendName == "icu" || (backendName == "winapi" && std::use_facet<bl::info>(l).utf8())) {
+                    TEST_HAS_FACETS(bl::collator, l);
+                    TEST_HAS_FACET_STRING8(bl::collator, l);
+                } else {
+                    TEST(blt::has_not_facet<bl::collator<char>>(l));
+                    TEST(blt::has_not_facet<bl::collator<wchar_t>>(l));
+                    TEST_FOR_STRING8(blt::has_not_facet<bl::collator<char8_t>>(l));
+                    TEST_FOR_CHAR16(blt::has_not_facet<bl::collator<char16_t>>(l));
+                    TEST_FOR_CHAR32(blt::has_not_facet<bl::collator<char32_t>>(l));
+                }
+                // Formatting
+                TEST_HAS_FACETS(std::num_put, l);
+                TEST_HAS_FACETS(std::time_put, l);
+                TEST_HAS_FACETS(std::numpunct, l);
+                TEST_HAS_FACETS(std::moneypunct, l);
+                // Parsing
+                TEST_HAS_FACETS(std::num_get, l);
+                // Message
+                TEST_HAS_FACETS(bl::message_format, l);
+                TEST_HAS_FACET_STRING8(bl::message_format, l);
+                // Codepage
+                TEST_HAS_FACETS(codecvt_by_char_type, l);
+                // Boundary
+                if(backendName == "icu") {
+                    TEST_HAS_FACETS(bl::boundary::boundary_indexing, l);
+                    TEST_HAS_FACET_CHAR8(bl::boundary::boundary_indexing, l);
+                }
+                // calendar
+                TEST(blt::has_facet<bl::calendar_facet>(l));
+                // information
+                TEST(blt::has_facet<bl::info>(l));
             }
-            // Formatting
-            TEST_HAS_FACETS(std::num_put, l);
-            TEST_HAS_FACETS(std::time_put, l);
-            TEST_HAS_FACETS(std::numpunct, l);
-            TEST_HAS_FACETS(std::moneypunct, l);
-            // Parsing
-            TEST_HAS_FACETS(std::num_get, l);
-            // Message
-            TEST_HAS_FACETS(bl::message_format, l);
-            TEST_HAS_FACET_STRING8(bl::message_format, l);
-            // Codepage
-            TEST_HAS_FACETS(codecvt_by_char_type, l);
-            // Boundary
-            if(backendName == "icu") {
-                TEST_HAS_FACETS(bl::boundary::boundary_indexing, l);
-                TEST_HAS_FACET_CHAR8(bl::boundary::boundary_indexing, l);
-            }
-            // calendar
-            TEST(blt::has_facet<bl::calendar_facet>(l));
-            // information
-            TEST(blt::has_facet<bl::info>(l));
         }
+        g.share_facets(false);
 
         std::locale l = g("en_US.UTF-8");
         TEST(has_message(l));
@@ -470,10 +577,179 @@ void test_main(int /*argc*/, char** /*argv*/)
         TEST(std::use_facet<bl::info>(g("en_US.UTF-8")).utf8());
         TEST(!std::use_facet<bl::info>(g("en_US.ISO8859-1")).utf8());
 
+        // Check the cache limit and statistics
+        {
+            bl::generator g2;
+            g2.categories(bl::category_t::information);
+            g2.locale_cache_enabled(true);
+            TEST_EQ(g2.locale_cache_limit(), 0u);
+            g2.locale_cache_limit(2);
+            TEST_EQ(g2.locale_cache_limit(), 2u);
+            g2.generate(l_wt, "en_US.UTF-8");
+            g2.generate(l_wt, "en_US.ISO8859-1");
+            TEST(blt::has_facet<test_facet>(g2("en_US.UTF-8")));
+            auto stats = g2.locale_cache_stats();
+            TEST_EQ(stats.hits, 1u);
+            TEST_EQ(stats.misses, 2u);
+            TEST_EQ(stats.evictions, 0u);
+            TEST(stats.generation_time.count() >= 0);
+            // Least recently used locale is removed
+            g2("da_DK.ISO8859-15@euro");
+            stats = g2.locale_cache_stats();
+            TEST_EQ(stats.misses, 3u);
+            TEST_EQ(stats.evictions, 1u);
+            TEST(blt::has_facet<test_facet>(g2("en_US.UTF-8")));
+            TEST(!blt::has_facet<test_facet>(g2("en_US.ISO8859-1")));
+            stats = g2.locale_cache_stats();
+            TEST_EQ(stats.hits, 2u);
+            TEST_EQ(stats.misses, 4u);
+            TEST_EQ(stats.evictions, 2u);
+            // Reducing the limit removes locales immediately
+            g2.locale_cache_limit(1);
+            TEST_EQ(g2.locale_cache_stats().evictions, 3u);
+            TEST(!blt::has_facet<test_facet>(g2("en_US.ISO8859-1")));
+            TEST(!blt::has_facet<test_facet>(g2("en_US.UTF-8")));
+        }
+        // Check different spellings of a locale share the cache entry
+        {
+            bl::generator g2;
+            g2.categories(bl::category_t::information);
+            g2.locale_cache_enabled(true);
+            // The locale is generated from the canonical spelling, independent of the spelling requested first
+            const std::locale l = g2("en-us.utf8");
+            TEST_EQ(std::use_facet<bl::info>(l).name(), "en_US.UTF-8");
+            g2.locale_cache_enabled(false);
+            TEST_EQ(std::use_facet<bl::info>(g2("en-us.utf8")).name(), "en-us.utf8");
+            g2.locale_cache_enabled(true);
+            TEST(&std::use_facet<bl::info>(g2("en_US.UTF-8")) == &std::use_facet<bl::info>(l));
+            TEST(&std::use_facet<bl::info>(g2("EN_us.Utf-8")) == &std::use_facet<bl::info>(l));
+            TEST_EQ(g2.locale_cache_stats().misses, 1u);
+            TEST_EQ(g2.locale_cache_stats().hits, 2u);
+            // Other encodings are different locales
+            g2("en_US.ISO8859-1");
+            g2("en_US.US-ASCII");
+            g2("en_US");
+            TEST_EQ(g2.locale_cache_stats().misses, 4u);
+            TEST_EQ(std::use_facet<bl::info>(g2("en_US.US-ASCII")).name(), "en_US.US-ASCII");
+            // Invalid ids are used as-is
+            g2("_invalid");
+            g2("_invalid");
+            TEST_EQ(g2.locale_cache_stats().misses, 5u);
+        }
+        // Check generating locales in advance
+        {
+            bl::generator g2;
+            g2.categories(bl::category_t::information);
+            g2.locale_cache_enabled(true);
+            std::vector<std::function<void()>> tasks;
+            std::vector<std::string> ready_ids;
+            g2.prewarm(
+              {"en_US.UTF-8", "en_US.ISO8859-1"},
+              [&tasks](std::function<void()> task) { tasks.push_back(std::move(task)); },
+              [&ready_ids](const std::string& id, std::exception_ptr error) {
+                  TEST(!error);
+                  ready_ids.push_back(id);
+              });
+            TEST_EQ(tasks.size(), 2u);
+            TEST(ready_ids.empty());
+            TEST_EQ(g2.locale_cache_stats().misses, 0u);
+            for(const auto& task : tasks)
+                task();
+            TEST_EQ(ready_ids, (std::vector<std::string>{"en_US.UTF-8", "en_US.ISO8859-1"}));
+            TEST_EQ(g2.locale_cache_stats().misses, 2u);
+            TEST(std::use_facet<bl::info>(g2("en_US.UTF-8")).utf8());
+            TEST(!std::use_facet<bl::info>(g2("en_US.ISO8859-1")).utf8());
+            TEST_EQ(g2.locale_cache_stats().hits, 2u);
+            TEST_EQ(g2.locale_cache_stats().misses, 2u);
+            // Callback is optional
+            g2.prewarm({"en_US.UTF-8"}, [](std::function<void()> task) { task(); });
+            TEST_EQ(g2.locale_cache_stats().hits, 3u);
+        }
+
+        // Check sharing facets between locales
+        {
+            bl::generator g2, g3;
+            TEST(!g2.share_facets());
+            // Generated before enabling the option, which must be used by later generations nonetheless
+            const std::locale l0 = g2("en_US.UTF-8");
+            g2.share_facets(true);
+            TEST(g2.share_facets());
+            g3.share_facets(true);
+            g3.add_messages_domain("other");
+            const std::locale l1 = g2("en_US.UTF-8");
+            const std::locale l2 = g3("en_US.UTF-8");
+            TEST(&std::use_facet<bl::info>(l1) == &std::use_facet<bl::info>(l2));
+            TEST(&std::use_facet<bl::info>(l0) != &std::use_facet<bl::info>(l1));
+            TEST(&std::use_facet<bl::converter<char>>(l1) == &std::use_facet<bl::converter<char>>(l2));
+            TEST(&std::use_facet<std::num_put<char>>(l1) == &std::use_facet<std::num_put<char>>(l2));
+            TEST(&std::use_facet<std::collate<wchar_t>>(l1) == &std::use_facet<std::collate<wchar_t>>(l2));
+            // Messages depend on the domains
+            TEST(&std::use_facet<bl::message_format<char>>(l1) != &std::use_facet<bl::message_format<char>>(l2));
+            // Different locales or locales generated without the option don't share facets
+            TEST(&std::use_facet<bl::info>(g2("en_US.ISO8859-1")) != &std::use_facet<bl::info>(l1));
+            const std::locale l_own = g("en_US.UTF-8");
+            TEST(&std::use_facet<bl::info>(l_own) != &std::use_facet<bl::info>(l1));
+            // Shared facets work like own ones
+            std::ostringstream ss_shared, ss_own;
+            ss_shared.imbue(l1);
+            ss_own.imbue(l_own);
+            ss_shared << bl::as::number << 1234.5 << ' ' << bl::to_upper("hello", l1);
+            ss_own << bl::as::number << 1234.5 << ' ' << bl::to_upper("hello", l_own);
+            TEST_EQ(ss_shared.str(), ss_own.str());
+            // Cleared facets are created anew, existing locales still work
+            bl::clear_shared_facets();
+            TEST(&std::use_facet<bl::info>(g2("en_US.UTF-8")) != &std::use_facet<bl::info>(l1));
+            TEST(std::use_facet<bl::info>(l1).utf8());
+        }
+
+        // Check reporting events to observers
+        {
+            const auto observer = std::make_shared<counting_observer>();
+            const auto global_observer = std::make_shared<counting_observer>();
+            TEST(!bl::localization_backend_manager::global_observer(global_observer));
+            bl::generator g2;
+            g2.categories(bl::category_t::convert | bl::category_t::information);
+            g2.characters(bl::char_facet_t::char_f);
+            g2.locale_cache_enabled(true);
+            TEST(!g2.observer());
+            g2.observer(observer);
+            TEST(g2.observer() == observer);
+            const std::locale l1 = g2("en_US.UTF-8");
+            g2("en_US.UTF-8");
+            // Without an observer of the generator the global one is used
+            g2.observer(nullptr);
+            g2.locale_cache_enabled(false);
+            const std::locale l2 = g2("en_US.UTF-8");
+            bl::to_upper("i", l1);
+            TEST(bl::localization_backend_manager::global_observer(nullptr) == global_observer);
+#ifdef BOOST_LOCALE_ENABLE_INSTRUMENTATION
+            TEST_EQ(observer->misses, 1);
+            TEST_EQ(observer->hits, 1);
+            TEST_EQ(observer->installations, 2);
+            TEST_EQ(global_observer->installations, 2);
+            TEST_EQ(global_observer->icu_objects > 0, backendName == "icu");
+            // Replacing the global observer takes effect for the following events
+            g2("en_US.UTF-8");
+            TEST_EQ(global_observer->installations, 2);
+            const auto global_observer2 = std::make_shared<counting_observer>();
+            bl::localization_backend_manager::global_observer(global_observer2);
+            g2("en_US.UTF-8");
+            TEST(bl::localization_backend_manager::global_observer(nullptr) == global_observer2);
+            g2("en_US.UTF-8");
+            TEST_EQ(global_observer->installations, 2);
+            TEST_EQ(global_observer2->installations, 2);
+#else
+            TEST_EQ(observer->misses + observer->hits + observer->installations, 0);
+            TEST_EQ(global_observer->installations + global_observer->icu_objects, 0);
+#endif
+        }
+
         test_install_chartype(backendName);
         test_std_collate_replaced(backendName);
     }
     std::cout << "Test special locales" << std::endl;
     test_special_locales();
     test_invalid_locale();
+    std::cout << "Test concurrent generation" << std::endl;
+    test_concurrent_generation();
 }
@@ -12,10 +12,15 @@
 #include <boost/locale/message.hpp>
 #include "boostLocale/test/tools.hpp"
 #include "boostLocale/test/unit_test.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace bl = boost::locale;
@@ -599,6 +604,478 @@ void test_main(int argc, char** argv)
         TEST(file_loader_is_actually_called);
         TEST_EQ(bl::translate("hello").str(l), "שלום");
     }
+    std::cout << "Testing catalogs without hash table" << std::endl;
+    {
+        boost::locale::generator g;
+        g.add_messages_domain("default_nohash");
+        g.add_messages_path(message_path);
+        const std::locale l = g("he_IL.UTF-8");
+        test_translate("hello", "שלום", l, "default_nohash");
+        test_translate("untranslated", "untranslated", l, "default_nohash");
+        test_ctranslate("context", "hello", "שלום בהקשר אחר", l, "default_nohash");
+        test_ntranslate("x day", "x days", 2, "יומיים", l, "default_nohash");
+        test_ntranslate("x day", "x days", 20, "x יום", l, "default_nohash");
+        test_cntranslate("context", "x day", "x days", 1, "בהקשר יום x", l, "default_nohash");
+    }
+    std::cout << "Testing lazily converted catalogs" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+
+        std::unique_ptr<bl::message_format<wchar_t>> facet(bl::gnu_gettext::create_messages_facet<wchar_t>(info));
+        const wchar_t* translated = facet->get(0, nullptr, L"hello");
+        TEST_REQUIRE(translated);
+        TEST_EQ(std::wstring(translated), to<wchar_t>("שלום"));
+        // Converted only once
+        TEST(facet->get(0, nullptr, L"hello") == translated);
+        TEST(facet->get(0, L"", L"hello") == translated);
+        TEST_EQ(std::wstring(facet->get(0, L"context", L"hello")), to<wchar_t>("שלום בהקשר אחר"));
+        TEST_EQ(std::wstring(facet->get(0, nullptr, L"x day", 2)), to<wchar_t>("יומיים"));
+        TEST(facet->get(0, nullptr, L"untranslated") == nullptr);
+        TEST(facet->get(0, L"context", L"untranslated") == nullptr);
+        const std::wstring wtest = bl::conv::utf_to_utf<wchar_t>("בדיקה");
+        TEST_EQ(std::wstring(facet->get(0, nullptr, wtest.c_str())), L"test");
+    }
+    std::cout << "Testing custom catalog buffers" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+
+        // Catalog content owned by the caller and only referenced
+        const std::vector<char> catalog = file_loader()(message_path + "/he/LC_MESSAGES/default.mo", "UTF-8");
+        TEST_REQUIRE(!catalog.empty());
+        info.buffer_callback = [&catalog](const std::string& name, const std::string&) {
+            if(name.find("/he/") == std::string::npos)
+                return bl::gnu_gettext::catalog_buffer();
+            return bl::gnu_gettext::catalog_buffer::view(catalog.data(), catalog.size());
+        };
+        {
+            std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+            TEST_EQ(bl::translate("hello").str(l), "שלום");
+            TEST_EQ(bl::translate("x day", "x days", 2).str(l), "יומיים");
+        }
+        // Shared catalog released when the last facet using it is gone
+        int num_released = 0;
+        info.buffer_callback = [&catalog, &num_released](const std::string& name, const std::string&) {
+            if(name.find("/he/") == std::string::npos)
+                return bl::gnu_gettext::catalog_buffer();
+            const std::shared_ptr<const void> storage(catalog.data(), [&num_released](const void*) { ++num_released; });
+            return bl::gnu_gettext::catalog_buffer(catalog.data(), catalog.size(), storage);
+        };
+        // Takes precedence over the other callback
+        info.callback = [](const std::string&, const std::string&) -> std::vector<char> {
+            throw std::logic_error("Unexpected call"); // LCOV_EXCL_LINE
+        };
+        {
+            std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+            TEST_EQ(num_released, 0);
+            TEST_EQ(bl::translate("hello").str(l), "שלום");
+            std::locale l2 = l;
+            l = std::locale();
+            TEST_EQ(num_released, 0);
+            TEST_EQ(bl::translate("hello").str(l2), "שלום");
+        }
+        TEST_EQ(num_released, 1);
+    }
+    std::cout << "Testing memory mapped catalogs" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("simple"));
+        info.use_memory_mapping = true;
+
+        std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST_EQ(bl::translate("x day", "x days", 2).str(l), "יומיים");
+        TEST_EQ(bl::translate("hello").str(l, "simple"), "היי");
+        std::locale lw(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info));
+        TEST_EQ(bl::translate(L"hello").str(lw), to<wchar_t>("שלום"));
+
+        boost::locale::generator g;
+        TEST(!g.use_memory_mapped_catalogs());
+        g.use_memory_mapped_catalogs(true);
+        TEST(g.use_memory_mapped_catalogs());
+        g.add_messages_domain("default");
+        g.add_messages_path(message_path);
+        l = g("he_IL.UTF-8");
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("שלום"));
+    }
+    std::cout << "Testing reloading of catalogs" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        info.cache_literal_lookups = true;
+
+        const std::vector<char> default_catalog = file_loader()(message_path + "/he/LC_MESSAGES/default.mo", "UTF-8");
+        const std::vector<char> simple_catalog = file_loader()(message_path + "/he/LC_MESSAGES/simple.mo", "UTF-8");
+        std::vector<char> catalog = default_catalog;
+        info.callback = [&catalog](const std::string& name, const std::string&) {
+            return (name.find("/he/") == std::string::npos) ? std::vector<char>() : catalog;
+        };
+        std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        l = std::locale(l, boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info));
+        const auto& facet = std::use_facet<bl::message_format<char>>(l);
+        const char* const translation = facet.get(0, nullptr, "hello");
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("שלום"));
+
+        catalog = simple_catalog;
+        TEST(bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST_EQ(bl::translate("hello").str(l), "היי");
+        TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("שלום"));
+        TEST(bl::gnu_gettext::reload_messages_catalogs<wchar_t>(l));
+        TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("היי"));
+        // Previous translations stay valid
+        TEST_EQ(std::string(translation), "שלום");
+
+        catalog.clear();
+        TEST(bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST_EQ(bl::translate("hello").str(l), "hello");
+        // Unchanged as no catalog is found
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        catalog = default_catalog;
+        TEST(bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST(bl::gnu_gettext::reload_messages_catalogs<wchar_t>(l));
+        // Catalogs with unchanged content are not loaded again
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<wchar_t>(l));
+        info.callback = nullptr;
+        info.buffer_callback = [&default_catalog](const std::string& name, const std::string&) {
+            return (name.find("/he/") == std::string::npos) ?
+                     bl::gnu_gettext::catalog_buffer() :
+                     bl::gnu_gettext::catalog_buffer::view(default_catalog.data(), default_catalog.size());
+        };
+        l = std::locale(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        l = std::locale(l, boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info));
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<wchar_t>(l));
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+
+        // Catalogs from the file system are only reloaded when modified
+        info.buffer_callback = nullptr;
+        l = std::locale(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<wchar_t>(l));
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(std::locale::classic()));
+
+        // Catalogs replaced by files of the same size right after loading them are reloaded
+        const std::string reloaded_path = message_path + "/he/LC_MESSAGES/reloaded.mo";
+        const std::string new_path = reloaded_path + ".new";
+        remove_file_on_exit remove_reloaded(reloaded_path), remove_new(new_path);
+        const auto write_catalog = [](const std::string& path, const std::vector<char>& data) {
+            std::ofstream f(path.c_str(), std::ofstream::binary);
+            f.write(data.data(), data.size());
+        };
+        write_catalog(reloaded_path, default_catalog);
+        info.domains.front() = bl::gnu_gettext::messages_info::domain("reloaded");
+        l = std::locale(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        TEST_EQ(bl::gettext("בדיקה", l), "test");
+        std::vector<char> modified_catalog = default_catalog;
+        const std::string test_str = "test";
+        const auto pos =
+          std::search(modified_catalog.begin(), modified_catalog.end(), test_str.begin(), test_str.end());
+        TEST_REQUIRE(pos != modified_catalog.end());
+        *pos = 'b';
+        write_catalog(new_path, modified_catalog);
+        std::remove(reloaded_path.c_str());
+        TEST_EQ(std::rename(new_path.c_str(), reloaded_path.c_str()), 0);
+        TEST(bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST_EQ(bl::gettext("בדיקה", l), "best");
+    }
+    std::cout << "Testing lazily loaded catalogs" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("simple"));
+        info.lazy_loading = true;
+
+        std::vector<std::string> loaded_files;
+        info.callback = [&loaded_files](const std::string& name, const std::string& encoding) {
+            loaded_files.push_back(name);
+            return file_loader()(name, encoding);
+        };
+        std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        TEST(loaded_files.empty());
+        TEST_EQ(bl::translate("hello").str(l, "simple"), "היי");
+        TEST(!loaded_files.empty());
+        for(const std::string& name : loaded_files)
+            TEST(name.find("simple.mo") != std::string::npos);
+        const size_t num_loaded = loaded_files.size();
+        TEST_EQ(bl::translate("hello").str(l, "simple"), "היי");
+        TEST_EQ(loaded_files.size(), num_loaded);
+        TEST_EQ(bl::translate("x day", "x days", 2).str(l), "יומיים");
+        TEST_GT(loaded_files.size(), num_loaded);
+
+        // Catalogs failing to load are not read again on each lookup
+        int num_invalid_loads = 0;
+        info.callback = [&num_invalid_loads](const std::string& name, const std::string&) {
+            if(name.find("/he/") == std::string::npos)
+                return std::vector<char>();
+            ++num_invalid_loads;
+            return std::vector<char>(10, 'x');
+        };
+        l = std::locale(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        TEST_THROWS(bl::translate("hello").str(l), std::runtime_error);
+        TEST_THROWS(bl::translate("hello").str(l), std::runtime_error);
+        TEST_EQ(num_invalid_loads, 1);
+        // Loading is retried after a reload
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        TEST_THROWS(bl::translate("hello").str(l), std::runtime_error);
+        TEST_EQ(num_invalid_loads, 2);
+
+        boost::locale::generator g;
+        TEST(!g.lazy_catalog_loading());
+        g.lazy_catalog_loading(true);
+        TEST(g.lazy_catalog_loading());
+        g.add_messages_domain("default");
+        g.add_messages_path(message_path);
+        l = g("he_IL.UTF-8");
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("שלום"));
+        TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(l));
+    }
+    std::cout << "Testing cached catalog directories" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.variant = "euro";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path + "/non-existing");
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("non-existing"));
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("simple"));
+        info.cache_catalog_directories = true;
+
+        for(int i = 0; i < 2; i++) {
+            std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+            TEST_EQ(bl::translate("hello").str(l), "hello");
+            TEST_EQ(bl::translate("hello").str(l, "default"), "שלום");
+            TEST_EQ(bl::translate("hello").str(l, "simple"), "היי");
+            std::locale lw(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info));
+            TEST_EQ(bl::translate(L"hello").str(lw, "default"), to<wchar_t>("שלום"));
+            TEST(!bl::gnu_gettext::reload_messages_catalogs<char>(l));
+        }
+        bl::gnu_gettext::clear_catalog_directory_cache();
+
+        boost::locale::generator g;
+        TEST(!g.cache_catalog_directories());
+        g.cache_catalog_directories(true);
+        TEST(g.cache_catalog_directories());
+        g.add_messages_domain("default");
+        g.add_messages_path(message_path);
+        std::locale l = g("he_IL.UTF-8");
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("שלום"));
+        bl::gnu_gettext::clear_catalog_directory_cache();
+
+        // More directories than cached at once
+        info.paths.clear();
+        for(int i = 0; i < 300; i++)
+            info.paths.push_back(message_path + "/missing" + std::to_string(i));
+        info.paths.push_back(message_path);
+        for(int i = 0; i < 2; i++) {
+            std::locale l2(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+            TEST_EQ(bl::translate("hello").str(l2, "default"), "שלום");
+        }
+        bl::gnu_gettext::clear_catalog_directory_cache();
+    }
+    std::cout << "Testing reporting loaded catalogs" << std::endl;
+    {
+        struct catalog_observer : bl::generation_observer {
+            std::vector<std::pair<std::string, size_t>> catalogs;
+            void catalog_loaded(const std::string& file_name, size_t size) override
+            {
+                catalogs.emplace_back(file_name, size);
+            }
+        };
+        const auto observer = std::make_shared<catalog_observer>();
+        bl::localization_backend_manager::global_observer(observer);
+        bl::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        std::locale l(std::locale::classic(), bl::gnu_gettext::create_messages_facet<char>(info));
+        bl::localization_backend_manager::global_observer(nullptr);
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+#ifdef BOOST_LOCALE_ENABLE_INSTRUMENTATION
+        TEST_EQ(observer->catalogs.size(), 1u);
+        TEST_EQ(observer->catalogs[0].first, message_path + "/he/LC_MESSAGES/default.mo");
+        TEST_GT(observer->catalogs[0].second, 0u);
+#else
+        TEST(observer->catalogs.empty());
+#endif
+    }
+    std::cout << "Testing prepared catalogs" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+
+        // Catalog without hash table gets one
+        const std::vector<char> prepared = bl::gnu_gettext::prepare_catalog(
+          bl::gnu_gettext::catalog_buffer(file_loader()(message_path + "/he/LC_MESSAGES/default_nohash.mo", "")),
+          "UTF-8");
+        info.encoding = "UTF-8";
+        info.callback = [&prepared](const std::string& name, const std::string&) {
+            return (name.find("/he/") == std::string::npos) ? std::vector<char>() : prepared;
+        };
+        std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        TEST_EQ(bl::translate("hello").str(l), "שלום");
+        TEST_EQ(bl::translate("context", "hello").str(l), "שלום בהקשר אחר");
+        TEST_EQ(bl::translate("x day", "x days", 1).str(l), "יום x");
+        TEST_EQ(bl::translate("x day", "x days", 2).str(l), "יומיים");
+        TEST_EQ(bl::translate("not translated").str(l), "not translated");
+        // Keys of plural entries contain the plural form of the id as in the original catalog
+        const std::string plural_key("x day\0x days", 12);
+        TEST(std::search(prepared.begin(), prepared.end(), plural_key.begin(), plural_key.end()) != prepared.end());
+        l = std::locale(l, boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info));
+        TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("שלום"));
+
+        if(iso_8859_8_supported) {
+            const std::vector<char> prepared_8bit = bl::gnu_gettext::prepare_catalog(
+              bl::gnu_gettext::catalog_buffer(file_loader()(message_path + "/he/LC_MESSAGES/default.mo", "")),
+              "ISO-8859-8");
+            info.encoding = "ISO-8859-8";
+            info.domains.back() = bl::gnu_gettext::messages_info::domain("default/ISO-8859-8");
+            info.callback = [&prepared_8bit](const std::string& name, const std::string&) {
+                return (name.find("/he/") == std::string::npos) ? std::vector<char>() : prepared_8bit;
+            };
+            l = std::locale(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+            TEST_EQ(bl::translate("hello").str(l), bl::conv::from_utf("שלום", "ISO-8859-8"));
+            TEST_EQ(bl::translate("x day", "x days", 2).str(l), bl::conv::from_utf("יומיים", "ISO-8859-8"));
+            const std::string key = bl::conv::from_utf("בדיקה", "ISO-8859-8");
+            TEST_EQ(bl::gettext(key.c_str(), l), "test");
+            TEST(std::search(prepared_8bit.begin(), prepared_8bit.end(), plural_key.begin(), plural_key.end())
+                 != prepared_8bit.end());
+        }
+        // Characters which can't be represented are not dropped
+        TEST_THROWS(bl::gnu_gettext::prepare_catalog(
+                      bl::gnu_gettext::catalog_buffer(file_loader()(message_path + "/he/LC_MESSAGES/default.mo", "")),
+                      "ISO-8859-1"),
+                    bl::conv::conversion_error);
+        const bl::gnu_gettext::catalog_buffer invalid(std::vector<char>(10, 'x'));
+        TEST_THROWS(bl::gnu_gettext::prepare_catalog(invalid, "UTF-8"), std::runtime_error);
+    }
+    std::cout << "Testing catalogs with an invalid number of entries" << std::endl;
+    {
+        // Catalog with a hash table and a valid header entry claiming many more entries than the file contains
+        const std::string header_entry = "Content-Type: text/plain; charset=UTF-8\n";
+        const uint32_t header_len = static_cast<uint32_t>(header_entry.size());
+        const uint32_t tables[] = {0x950412de, 0, 0x1FFFFFFF, 28, 36, 3, 44, 0, 56, header_len, 57, 0, 0, 0};
+        std::vector<char> catalog(sizeof(tables) + 1);
+        std::memcpy(catalog.data(), tables, sizeof(tables));
+        catalog.insert(catalog.end(), header_entry.begin(), header_entry.end());
+        catalog.push_back('\0');
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        info.callback = [&catalog](const std::string&, const std::string&) { return catalog; };
+        TEST_THROWS(boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info), std::runtime_error);
+        TEST_THROWS(boost::locale::gnu_gettext::create_messages_facet<char>(info), std::runtime_error);
+        TEST_THROWS(bl::gnu_gettext::prepare_catalog(bl::gnu_gettext::catalog_buffer(catalog), "UTF-8"),
+                    std::runtime_error);
+    }
+    std::cout << "Testing catalogs with invalid UTF-8" << std::endl;
+    {
+        // Catalog without hash table with the header entry and an entry with an invalid translation
+        const std::string header_entry = "Content-Type: text/plain; charset=UTF-8\n";
+        const uint32_t header_len = static_cast<uint32_t>(header_entry.size());
+        const uint32_t tables[] = {0x950412de, 0, 2, 28, 44, 0, 60, 0, 60, 1, 61, header_len, 63, 1, 64 + header_len};
+        std::vector<char> catalog(sizeof(tables));
+        std::memcpy(catalog.data(), tables, sizeof(tables));
+        catalog.push_back('\0');
+        catalog.push_back('a');
+        catalog.push_back('\0');
+        catalog.insert(catalog.end(), header_entry.begin(), header_entry.end());
+        catalog.push_back('\0');
+        catalog.push_back('\xFF');
+        catalog.push_back('\0');
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        info.callback = [&catalog](const std::string&, const std::string&) { return catalog; };
+        TEST_THROWS(boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info), bl::conv::conversion_error);
+        // Without the invalid entry the catalog can be used
+        catalog[catalog.size() - 2] = 'b';
+        const std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info));
+        TEST_EQ(bl::translate(L"a").str(l), L"b");
+        // Keys which are not valid UTF don't match any entry
+        const std::wstring invalid_key(1, static_cast<wchar_t>(0xD800));
+        TEST_EQ(bl::translate(invalid_key).str(l), invalid_key);
+    }
+    std::cout << "Testing cached literal lookups" << std::endl;
+    {
+        boost::locale::gnu_gettext::messages_info info;
+        info.language = "he";
+        info.country = "IL";
+        info.encoding = "UTF-8";
+        info.paths.push_back(message_path);
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("default"));
+        info.domains.push_back(bl::gnu_gettext::messages_info::domain("simple"));
+        info.cache_literal_lookups = true;
+
+        std::locale l(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<char>(info));
+        std::locale lw(std::locale::classic(), boost::locale::gnu_gettext::create_messages_facet<wchar_t>(info));
+        // Repeat to use the cached results
+        for(int i = 0; i < 3; i++) {
+            TEST_EQ(bl::translate("hello").str(l), "שלום");
+            TEST_EQ(bl::translate("context", "hello").str(l), "שלום בהקשר אחר");
+            TEST_EQ(bl::translate("hello").str(l, "simple"), "היי");
+            TEST_EQ(bl::translate("x day", "x days", 1).str(l), "יום x");
+            TEST_EQ(bl::translate("x day", "x days", 2).str(l), "יומיים");
+            TEST_EQ(bl::translate("not translated").str(l), "not translated");
+            TEST_EQ(bl::translate(L"hello").str(lw), to<wchar_t>("שלום"));
+            TEST_EQ(bl::translate(L"x day", L"x days", 2).str(lw), to<wchar_t>("יומיים"));
+            // Messages from std::string are never cached
+            TEST_EQ(bl::translate(std::string("hello")).str(l), "שלום");
+            TEST_EQ(bl::translate(std::string("context"), std::string("hello")).str(l), "שלום בהקשר אחר");
+        }
+
+        boost::locale::generator g;
+        TEST(!g.cache_literal_lookups());
+        g.cache_literal_lookups(true);
+        TEST(g.cache_literal_lookups());
+        g.add_messages_domain("default");
+        g.add_messages_path(message_path);
+        l = g("he_IL.UTF-8");
+        for(int i = 0; i < 2; i++) {
+            TEST_EQ(bl::translate("hello").str(l), "שלום");
+            TEST_EQ(bl::translate(L"hello").str(l), to<wchar_t>("שלום"));
+        }
+    }
     if(iso_8859_8_supported) {
         std::cout << "Testing non-US-ASCII keys" << std::endl;
         std::cout << "  UTF-8 keys" << std::endl;